@@ -0,0 +1,76 @@
+#pragma once
+
+#include "GameState.h"
+#include "RoundKernel.h"
+
+// Parameterized stand-in for the answers pollUserInput asks the player for.
+class BotPolicy {
+public:
+    static constexpr int kParameterCount = 5;
+
+    double buy_below_price = 19;
+    double sell_above_price = 24;
+    double trade_fraction = 0.1;
+    double consumption_ratio = 1.0;
+    double sowing_ratio = 0.5;
+
+    // Maps a point of the unit cube onto the policy, used by the optimizer's search space
+    template <typename Rules>
+    static BotPolicy fromNormalized(const double* x) {
+        const double price_range = Rules::land_price_max - Rules::land_price_min;
+
+        BotPolicy policy;
+        policy.buy_below_price = Rules::land_price_min + clampUnit(x[0]) * price_range;
+        policy.sell_above_price = Rules::land_price_min + clampUnit(x[1]) * price_range;
+        policy.trade_fraction = clampUnit(x[2]);
+        policy.consumption_ratio = clampUnit(x[3]) * 1.5;
+        policy.sowing_ratio = clampUnit(x[4]);
+        return policy;
+    }
+
+    // Fills the round decisions, keeping them inside the same bounds getValidInput enforces
+    template <typename Rules>
+    void decide(GameState& state) const {
+        state.land_bought = 0;
+        state.land_sold = 0;
+
+        if (state.land_price <= buy_below_price && state.land_price > 0) {
+            state.land_bought = static_cast<int>(trade_fraction * state.wheat_amount) / state.land_price;
+        }
+        else if (state.land_price >= sell_above_price) {
+            state.land_sold = static_cast<int>(trade_fraction * state.land_amount);
+        }
+        state.land_bought = MathUtils::clamp(state.land_bought, 0, state.land_price > 0 ? state.wheat_amount / state.land_price : 0);
+        state.land_sold = MathUtils::clamp(state.land_sold, 0, state.land_amount - state.land_bought);
+
+        const int wheat_needed = static_cast<int>(consumption_ratio * state.population * Rules::wheat_per_person);
+        state.wheat_consumed = MathUtils::clamp(wheat_needed, 0, state.wheat_amount);
+
+        const int wheat_left = state.wheat_amount - state.wheat_consumed;
+        state.wheat_sown = MathUtils::clamp(static_cast<int>(sowing_ratio * wheat_left), 0, wheat_left);
+    }
+
+    // Plays one game to its evaluation round or game over with draws from random
+    template <typename Rules, typename Random>
+    GameState play(Random& random, const int evaluation_round_index, bool& game_over) const {
+        GameState state;
+        game_over = false;
+
+        while (state.round_index < evaluation_round_index) {
+            state.land_price = RoundKernel<Rules>::rollLandPrice(random);
+            decide<Rules>(state);
+
+            if (RoundKernel<Rules>::applyRound(state, RoundKernel<Rules>::rollRound(random)).game_over) {
+                game_over = true;
+                break;
+            }
+        }
+
+        return state;
+    }
+
+private:
+    static double clampUnit(const double value) {
+        return value < 0.0 ? 0.0 : (value > 1.0 ? 1.0 : value);
+    }
+};
@@ -0,0 +1,381 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "GameState.h"
+#include "OutcomeStatistics.h"
+#include "RoundHistory.h"
+#include "RoundKernel.h"
+#include "Rules.h"
+
+// Everything needed to resume a session besides its configuration
+struct SessionSnapshot {
+    GameState game_state;
+    uint64_t random_state = 0;
+};
+
+template <typename Rules = DefaultRules>
+class Game {
+public:
+    Game(const GameConfig& game_config) : Game(game_config, std::cin, std::cout) {
+        interactive_ = true;
+    }
+
+    // Scripted sessions read their answers from input and write prompts to output
+    Game(const GameConfig& game_config, std::istream& input, std::ostream& output) : random_(game_config.random_seed) {
+        game_config_ = game_config;
+        input_ = &input;
+        output_ = &output;
+        loadGameState(game_config_.save_game_path);
+    }
+
+    // Returns false once the player quits or the input runs out
+    bool processRoundTick() {
+        evaluateFinishedGame();
+
+        // A session that ends here is recorded as far as it got, the next tick would never come
+        if (!pollQuitGameRequest()) {
+            finishSessionHistory();
+            return false;
+        }
+
+        processPreUserInputRoundCalculations();
+        echoGameState();
+        return pollAndApplyUserInput();
+    }
+
+    // A hosted session splits the tick at the prompt: beginRound shows the round with its price and asks
+    // whether to quit, finishRound reads that answer and the trades, so the player trades at the price they saw
+    void beginRound() {
+        evaluateFinishedGame();
+        promptQuitGameRequest();
+        processPreUserInputRoundCalculations();
+        echoGameState();
+    }
+
+    // Returns false once the player quits or the input runs out
+    bool finishRound() {
+        if (!readQuitGameRequest()) {
+            finishSessionHistory();
+            return false;
+        }
+        return pollAndApplyUserInput();
+    }
+
+    // Finished sessions are appended to the store, pass nullptr to stop recording
+    void attachRoundHistory(RoundHistoryStore* round_history) {
+        round_history_ = round_history;
+        session_rounds_.clear();
+    }
+
+    // Evaluated games are recorded into the statistics, pass nullptr to stop recording
+    void attachOutcomeStatistics(OutcomeStatistics* outcome_statistics) {
+        outcome_statistics_ = outcome_statistics;
+    }
+
+    bool quitRequested() const {
+        return quit_requested_;
+    }
+
+    SessionSnapshot saveSession() const {
+        SessionSnapshot snapshot;
+        snapshot.game_state = game_state_;
+        snapshot.random_state = random_.state();
+        return snapshot;
+    }
+
+    void restoreSession(const SessionSnapshot& snapshot) {
+        game_state_ = snapshot.game_state;
+        random_ = SeededRandom(snapshot.random_state);
+        quit_requested_ = false;
+    }
+
+private:
+    GameState game_state_;
+    GameConfig game_config_;
+    SeededRandom random_;
+
+    // Prompts end with "\n" rather than std::endl, std::cin is tied to std::cout and flushes it before every read
+    std::istream* input_;
+    std::ostream* output_;
+    bool interactive_ = false;
+    bool quit_requested_ = false;
+
+    RoundHistoryStore* round_history_ = nullptr;
+    OutcomeStatistics* outcome_statistics_ = nullptr;
+    std::vector<GameState> session_rounds_;
+
+    static constexpr const char* game_input_messages_[4] = {
+        "How much acres would you like to buy?", 
+        "How much acres would you like to sell?", 
+        "How much wheat would you like to consume?", 
+        "How much wheat would you like to sow?"};
+
+    void saveGameState(const std::string& save_path) const
+    {
+        std::ofstream save_file(save_path);
+        if (!save_file) {
+            std::cerr << "Could not save the game." << std::endl;
+            return;
+        }
+
+        save_file 
+            << game_state_.round_index << "\n"
+            << game_state_.population << "\n"
+            << game_state_.land_amount << "\n"
+            << game_state_.wheat_amount << "\n"
+            << game_state_.people_died << "\n"
+            << game_state_.people_arrived << "\n"
+            << game_state_.land_price << "\n"
+            << game_state_.plague_multiplier << "\n"
+            << game_state_.wheat_per_acre << "\n"
+            << game_state_.wheat_lost << "\n"
+            << game_state_.people_died_totally << "\n"
+            << std::endl;
+
+        save_file.close();
+    }
+
+    void loadGameState(const std::string& save_path)
+    {
+        if (save_path.empty()) {
+            return;
+        }
+
+        std::ifstream save_file(save_path);
+        
+        if (!save_file) {
+            std::cerr << "Save file not found. Starting new session..." << std::endl;
+            return;
+        }
+        
+        char response;
+
+        *output_ << "Save file found. Type L to load the game. Type any other key to start new session.\n";
+        *input_ >> response;
+
+        if (response != 'L' && response != 'l') {
+            return;
+        }
+
+        save_file
+            >> game_state_.round_index
+            >> game_state_.population
+            >> game_state_.land_amount
+            >> game_state_.wheat_amount
+            >> game_state_.people_died
+            >> game_state_.people_arrived
+            >> game_state_.land_price
+            >> game_state_.plague_multiplier
+            >> game_state_.wheat_per_acre
+            >> game_state_.wheat_lost
+            >> game_state_.people_died_totally
+            ;
+
+        save_file.close();
+    }
+
+    void echoGameState() const
+    {
+        *output_
+            << "Current round: " << game_state_.round_index + 1<< "\n"
+            << "People starved to death: " << game_state_.people_died << "\n"
+            << "People Arrived: " << game_state_.people_arrived << "\n"
+            << "Plague multiplier: " << game_state_.plague_multiplier << "\n"
+            << "Population: " << game_state_.population << "\n"
+            << "Wheat: " << game_state_.wheat_amount << "\n"
+            << "Wheat per acre collected: " << game_state_.wheat_per_acre << "\n"
+            << "Wheat lost to rats: " << game_state_.wheat_lost << "\n"
+            << "Acres in use: " << game_state_.land_amount << "\n"
+            << "Acre price: " << game_state_.land_price << "\n"
+            << "\n";
+    }
+
+    void resetGameState() {
+        game_state_ = GameState();
+    }
+
+    void recordRoundHistory() {
+        if (round_history_ != nullptr) {
+            session_rounds_.push_back(game_state_);
+        }
+    }
+
+    void finishSessionHistory() {
+        if (round_history_ != nullptr && !session_rounds_.empty()) {
+            round_history_->appendSession(session_rounds_);
+        }
+        session_rounds_.clear();
+    }
+
+    void evaluateFinishedGame() {
+        if (game_state_.round_index >= game_config_.evaluation_round_index) {
+            evaluatePlayerPerformance();
+            finishSessionHistory();
+            resetGameState();
+        }
+    }
+
+    bool pollAndApplyUserInput() {
+        if (!pollUserInput()) {
+            finishSessionHistory();
+            return false;
+        }
+        processPostUserInputRoundCalculations();
+        return true;
+    }
+
+    bool pollQuitGameRequest()
+    {
+        promptQuitGameRequest();
+        return readQuitGameRequest();
+    }
+
+    void promptQuitGameRequest() const
+    {
+        *output_ << "Type Q to quit the game. Type any other key to proceed.\n";
+    }
+
+    bool readQuitGameRequest()
+    {
+        char response;
+        if (!(*input_ >> response)) {
+            return false;
+        }
+
+        if (response == 'Q' || response == 'q') {
+            quit_requested_ = true;
+            if (!game_config_.save_game_path.empty()) {
+                saveGameState(game_config_.save_game_path);
+            }
+            return false;
+        }
+        return true;
+    }
+
+    bool pollUserInput() {
+        int land_to_buy;
+        if (!getValidInput(game_input_messages_[0],
+                           [](const int input, const GameState& state)
+                           { return input >= 0 && input * state.land_price <= state.wheat_amount; },
+                           land_to_buy)) {
+            return false;
+        }
+        game_state_.land_bought = land_to_buy;
+
+        int land_to_sell;
+        if (!getValidInput(game_input_messages_[1],
+                           [](const int input, const GameState& state)
+                           { return input >= 0 && input <= state.land_amount - state.land_bought; },
+                           land_to_sell)) {
+            return false;
+        }
+        game_state_.land_sold = land_to_sell;
+
+        int wheat_to_consume;
+        if (!getValidInput(game_input_messages_[2],
+                           [](const int input, const GameState& state)
+                           { return input >= 0 && input <= state.wheat_amount; },
+                           wheat_to_consume)) {
+            return false;
+        }
+        game_state_.wheat_consumed = wheat_to_consume;
+
+        int wheat_to_sow;
+        if (!getValidInput(game_input_messages_[3],
+                           [](const int input, const GameState& state)
+                           { return input >= 0 && input <= state.wheat_amount - state.wheat_consumed; },
+                           wheat_to_sow)) {
+            return false;
+        }
+        game_state_.wheat_sown = wheat_to_sow;
+        return true;
+    }
+
+    // Returns false if the input ended before a valid value was read
+    bool getValidInput(const char* message, const std::function<bool(int, GameState)>& validity_predicate, int& value) const
+    {
+        bool is_valid;
+
+        do {
+            *output_ << message << "\n";
+            *input_ >> std::ws;
+            const std::streampos token_start = input_->tellg();
+            *input_ >> value;
+
+            is_valid = validity_predicate(value, game_state_);
+
+            if (input_->fail())
+            {
+                if (input_->eof()) {
+                    return false;
+                }
+                input_->clear();
+                skipInvalidInput(token_start);
+                is_valid = false;
+            }
+            
+            if (!is_valid) {
+                *output_ << "Invalid input\n";
+            }
+            
+        } while (!is_valid);
+
+        return true;
+    }
+
+    // A player retypes the whole line, a script carries on with the answer after the bad token,
+    // otherwise a one-line scripted session would lose every round after its first typo.
+    // A number too large for int fails after its digits were read, then the next token is already an answer.
+    void skipInvalidInput(const std::streampos token_start) const
+    {
+        if (interactive_) {
+            input_->ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            return;
+        }
+
+        const std::streampos position = input_->tellg();
+        if (token_start != std::streampos(-1) && position != std::streampos(-1) && position != token_start) {
+            return;
+        }
+
+        std::string token;
+        *input_ >> token;
+    }
+
+    void evaluatePlayerPerformance() const
+    {
+        const PerformanceGrade grade = RoundKernel<Rules>::evaluate(game_state_, game_config_.evaluation_round_index);
+        *output_ << RoundKernel<Rules>::gradeName(grade) << "\n";
+
+        if (outcome_statistics_ != nullptr) {
+            outcome_statistics_->recordEvaluatedGame(game_state_, grade);
+        }
+    }
+
+    void processPreUserInputRoundCalculations() {
+        game_state_.land_price = RoundKernel<Rules>::rollLandPrice(random_);
+    }
+
+    void processPostUserInputRoundCalculations() {
+        const RoundResult result = RoundKernel<Rules>::applyRound(game_state_, RoundKernel<Rules>::rollRound(random_));
+
+        if (result.game_over) {
+            *output_ << "Your mortality rate, " << result.mortality_rate << ", was too high... Game Over.\n";
+            if (outcome_statistics_ != nullptr) {
+                outcome_statistics_->recordGameOver();
+            }
+            recordRoundHistory();
+            finishSessionHistory();
+            resetGameState();
+            return;
+        }
+
+        recordRoundHistory();
+    }
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+class GameConfig {
+public:
+    GameConfig() = default;
+
+    GameConfig(const std::string& _saveGamePath, const int _evaluationRoundIndex) {
+        save_game_path = _saveGamePath;
+        evaluation_round_index = _evaluationRoundIndex;
+    }
+
+    std::string save_game_path;
+    int evaluation_round_index = 10;
+    uint64_t random_seed = 0;
+};
+
+class GameState {
+public: 
+    GameState() {
+        round_index = 0;
+        population = 100;
+        land_amount = 1000;
+        wheat_amount = 2800;
+        people_died = 0;
+        people_arrived = 0;
+        land_price = 0;
+        plague_multiplier = 0;
+        wheat_per_acre = 0;
+        wheat_lost = 0;
+
+        people_died_totally = 0;
+
+        land_bought = 0;
+        land_sold = 0;
+        wheat_consumed = 0;
+        wheat_sown = 0;
+    }
+
+    int round_index;
+    int population;
+    int land_amount;
+    int wheat_amount;
+    int people_died;
+    int people_arrived;
+    int land_price;
+    int plague_multiplier;
+    int wheat_per_acre;
+    int wheat_lost;
+
+    int people_died_totally;
+
+    int land_bought;
+    int land_sold;
+    int wheat_consumed;
+    int wheat_sown;
+};
+
+class MathUtils {
+public:
+    static int rollRandomIntInRange(const int min_val, const int max_val) {
+        return min_val + rand() % (max_val - min_val + 1);
+    }
+
+    static int clamp(const int n, const int min_val, const int max_val) {
+        return std::max(min_val, std::min(n, max_val));
+    }
+};
+
+// Per game random source for headless runs. Unlike rand() it can be seeded per game and thread,
+// so every candidate policy can be replayed against the same sequence of draws.
+class SeededRandom {
+public:
+    explicit SeededRandom(const uint64_t seed) : state_(seed) {}
+
+    // Feeding state() back into the constructor resumes the same sequence
+    uint64_t state() const {
+        return state_;
+    }
+
+    int rollIntInRange(const int min_val, const int max_val) {
+        return min_val + static_cast<int>(next() % static_cast<uint64_t>(max_val - min_val + 1));
+    }
+
+private:
+    uint64_t state_;
+
+    // splitmix64
+    uint64_t next() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
@@ -0,0 +1,414 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "BotPolicy.h"
+#include "GameState.h"
+#include "RoundKernel.h"
+
+struct DistributionConfig {
+    int evaluation_round_index = 10;
+    int thread_count = 0;
+    // Each resampled round adds at most p(1 - p) / max_frontier_states to the variance of a probability p.
+    // 1 << 14 keeps the default policy's estimates within about 0.003 of the exact values, peaking near
+    // ten million states; every doubling costs twice the time and memory for a sqrt(2) smaller error.
+    int max_frontier_states = 1 << 14;
+    uint64_t seed = 1;
+};
+
+struct OutcomeDistributionResult {
+    double grade_probabilities[static_cast<int>(PerformanceGrade::Excellent) + 1] = {};
+    double game_over_probability = 0.0;
+    int64_t states_expanded = 0;
+    int peak_frontier_size = 0;
+    int resampled_rounds = 0;
+    int max_frontier_states = 0;
+    double seconds = 0.0;
+
+    // False once a frontier had to be resampled, the probabilities are then unbiased estimates
+    bool isExact() const {
+        return resampled_rounds == 0;
+    }
+
+    double gradeProbability(const PerformanceGrade grade) const {
+        return grade_probabilities[static_cast<int>(grade)];
+    }
+
+    // Upper bound on the standard error of any estimated probability, as if every resampling drew
+    // max_frontier_states states independently; the systematic sweep does at least as well in practice.
+    // Bounded with p(1 - p) <= 1/4 rather than the estimate itself, which may be 0 where p is not.
+    double standardErrorBound() const {
+        return std::sqrt(resampled_rounds / (4.0 * max_frontier_states));
+    }
+
+    void printSummary(std::ostream& out) const {
+        static const PerformanceGrade grades[] = {
+            PerformanceGrade::Bad, PerformanceGrade::Satisfactory, PerformanceGrade::Good, PerformanceGrade::Excellent };
+
+        for (const PerformanceGrade grade : grades) {
+            out << RoundKernel<DefaultRules>::gradeName(grade) << " " << gradeProbability(grade) << "\n";
+        }
+        out << "Game over: " << game_over_probability << "\n";
+        if (isExact()) {
+            out << "Exact";
+        }
+        else {
+            out << "Resampled in " << resampled_rounds << " rounds, standard error at most " << standardErrorBound();
+        }
+        out << ", states expanded: " << states_expanded << ", peak frontier: " << peak_frontier_size
+            << ", " << seconds << " s\n";
+    }
+};
+
+// Computes the exact outcome distribution of a BotPolicy instead of sampling games.
+// Every round draws from a handful of uniform ranges (land price, yield, rats, plague), so the
+// probability mass of each reachable state is pushed through all of their combinations, one round
+// at a time. States that only differ in fields the next rounds overwrite are merged in a hash map.
+// The reachable states still multiply by a few hundred per round, so a frontier larger than
+// max_frontier_states is cut down with systematic resampling: states keep their mass in multiples of
+// total / max_frontier_states, picked along one seeded sweep over the states in key order. That keeps
+// the estimate unbiased and the run deterministic whatever the thread count; short horizons and
+// narrow rulesets stay exact.
+template <typename Rules>
+class OutcomeDistribution {
+public:
+    OutcomeDistribution(const DistributionConfig& config) {
+        config_ = config;
+        if (config_.thread_count <= 0) {
+            config_.thread_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        }
+        config_.max_frontier_states = std::max(1, config_.max_frontier_states);
+    }
+
+    OutcomeDistributionResult evaluatePolicy(const BotPolicy& policy) const {
+        const auto start = std::chrono::steady_clock::now();
+        const std::vector<Branch> branches = roundBranches();
+
+        SeededRandom random(config_.seed);
+
+        OutcomeDistributionResult result;
+        result.max_frontier_states = config_.max_frontier_states;
+        std::vector<std::pair<StateKey, double>> frontier(1, std::make_pair(StateKey(GameState()), 1.0));
+
+        for (int round_index = 0; round_index < config_.evaluation_round_index && !frontier.empty(); round_index++) {
+            result.peak_frontier_size = std::max(result.peak_frontier_size, static_cast<int>(frontier.size()));
+            if (static_cast<int>(frontier.size()) > config_.max_frontier_states) {
+                frontier = resample(std::move(frontier), config_.max_frontier_states, random);
+                result.resampled_rounds++;
+            }
+
+            result.states_expanded += static_cast<int64_t>(frontier.size());
+            frontier = expandRound(policy, branches, round_index, frontier, result);
+        }
+
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+private:
+    // The part of GameState that survives into the next round, everything else is rolled or decided anew
+    struct StateKey {
+        int population;
+        int land_amount;
+        int wheat_amount;
+        int people_died_totally;
+
+        StateKey() = default;
+
+        explicit StateKey(const GameState& state) {
+            population = state.population;
+            land_amount = state.land_amount;
+            wheat_amount = state.wheat_amount;
+            people_died_totally = state.people_died_totally;
+        }
+
+        GameState toState(const int round_index) const {
+            GameState state;
+            state.round_index = round_index;
+            state.population = population;
+            state.land_amount = land_amount;
+            state.wheat_amount = wheat_amount;
+            state.people_died_totally = people_died_totally;
+            return state;
+        }
+
+        bool operator==(const StateKey& other) const {
+            return population == other.population && land_amount == other.land_amount
+                && wheat_amount == other.wheat_amount && people_died_totally == other.people_died_totally;
+        }
+
+        bool operator<(const StateKey& other) const {
+            return std::tie(population, land_amount, wheat_amount, people_died_totally)
+                < std::tie(other.population, other.land_amount, other.wheat_amount, other.people_died_totally);
+        }
+    };
+
+    static uint64_t hashKey(const StateKey& key) {
+        uint64_t hash = static_cast<uint32_t>(key.population) | static_cast<uint64_t>(static_cast<uint32_t>(key.land_amount)) << 32;
+        hash ^= (static_cast<uint32_t>(key.wheat_amount) | static_cast<uint64_t>(static_cast<uint32_t>(key.people_died_totally)) << 32)
+            * 0x9E3779B97F4A7C15ULL;
+        hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+        return hash ^ (hash >> 31);
+    }
+
+    // Open addressing with linear probing, a round adds millions of short lived entries and
+    // node based maps spend most of the expansion in the allocator
+    class StateTable {
+    public:
+        StateTable() : slots_(kInitialCapacity) {}
+
+        void add(const StateKey& key, const uint64_t hash, const double probability) {
+            if ((size_ + 1) * 2 > slots_.size()) {
+                grow();
+            }
+
+            const size_t mask = slots_.size() - 1;
+            for (size_t index = hash & mask;; index = (index + 1) & mask) {
+                Slot& slot = slots_[index];
+                if (slot.key.population < 0) {
+                    slot.key = key;
+                    slot.hash = hash;
+                    slot.probability = probability;
+                    size_++;
+                    return;
+                }
+                if (slot.hash == hash && slot.key == key) {
+                    slot.probability += probability;
+                    return;
+                }
+            }
+        }
+
+        void mergeInto(StateTable& target) const {
+            for (const Slot& slot : slots_) {
+                if (slot.key.population >= 0) {
+                    target.add(slot.key, slot.hash, slot.probability);
+                }
+            }
+        }
+
+        void appendTo(std::vector<std::pair<StateKey, double>>& states) const {
+            for (const Slot& slot : slots_) {
+                if (slot.key.population >= 0) {
+                    states.push_back(std::make_pair(slot.key, slot.probability));
+                }
+            }
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+    private:
+        // Population never goes below zero, a negative one marks an empty slot
+        struct Slot {
+            StateKey key = emptyKey();
+            uint64_t hash = 0;
+            double probability = 0.0;
+        };
+
+        static constexpr size_t kInitialCapacity = 1024;
+
+        std::vector<Slot> slots_;
+        size_t size_ = 0;
+
+        static StateKey emptyKey() {
+            StateKey key;
+            key.population = -1;
+            key.land_amount = 0;
+            key.wheat_amount = 0;
+            key.people_died_totally = 0;
+            return key;
+        }
+
+        void grow() {
+            std::vector<Slot> old_slots(slots_.size() * 2);
+            old_slots.swap(slots_);
+            size_ = 0;
+            for (const Slot& slot : old_slots) {
+                if (slot.key.population >= 0) {
+                    add(slot.key, slot.hash, slot.probability);
+                }
+            }
+        }
+    };
+
+    // One combination of the draws made after the player's decisions, with its probability
+    struct Branch {
+        RoundRolls rolls;
+        double probability;
+    };
+
+    DistributionConfig config_;
+
+    // Plague rolls only matter through plague_chance_percent, so the plague_roll_max + 1 of them collapse into two branches
+    static std::vector<Branch> roundBranches() {
+        const int yield_count = Rules::wheat_per_acre_max - Rules::wheat_per_acre_min + 1;
+        const int rats_count = Rules::rats_loss_percent_max - Rules::rats_loss_percent_min + 1;
+        const int plague_roll_count = Rules::plague_roll_max + 1;
+        const int plague_count = MathUtils::clamp(Rules::plague_chance_percent + 1, 0, plague_roll_count);
+
+        const std::pair<int, int> plague_outcomes[] = {
+            std::make_pair(Rules::plague_chance_percent, plague_count),
+            std::make_pair(Rules::plague_chance_percent + 1, plague_roll_count - plague_count) };
+
+        std::vector<Branch> branches;
+        for (int wheat_per_acre = Rules::wheat_per_acre_min; wheat_per_acre <= Rules::wheat_per_acre_max; wheat_per_acre++) {
+            for (int rats = Rules::rats_loss_percent_min; rats <= Rules::rats_loss_percent_max; rats++) {
+                for (const std::pair<int, int>& plague : plague_outcomes) {
+                    if (plague.second == 0) {
+                        continue;
+                    }
+
+                    Branch branch;
+                    branch.rolls.wheat_per_acre = wheat_per_acre;
+                    branch.rolls.wheat_lost_percentage = rats;
+                    branch.rolls.plague_roll = plague.first;
+                    branch.probability = static_cast<double>(plague.second) / (static_cast<double>(plague_roll_count) * yield_count * rats_count);
+                    branches.push_back(branch);
+                }
+            }
+        }
+        return branches;
+    }
+
+    // Every thread expands a contiguous slice of the frontier into its own maps, one per shard of the
+    // key space, then every thread merges one shard across all of them. The frontier comes out in shard
+    // and table order, which depend on thread_count; resample sorts it before sweeping.
+    std::vector<std::pair<StateKey, double>> expandRound(const BotPolicy& policy, const std::vector<Branch>& branches,
+        const int round_index, const std::vector<std::pair<StateKey, double>>& frontier, OutcomeDistributionResult& result) const {
+        const int thread_count = std::min(config_.thread_count, std::max(1, static_cast<int>(frontier.size()) / kMinStatesPerThread));
+        const bool final_round = round_index + 1 >= config_.evaluation_round_index;
+        const double price_probability = 1.0 / (Rules::land_price_max - Rules::land_price_min + 1);
+
+        std::vector<std::vector<StateTable>> expanded(thread_count, std::vector<StateTable>(thread_count));
+        std::vector<OutcomeDistributionResult> partial_results(thread_count);
+
+        runOnThreads(thread_count, [&](const int thread_index) {
+            const size_t begin = frontier.size() * thread_index / thread_count;
+            const size_t end = frontier.size() * (thread_index + 1) / thread_count;
+            OutcomeDistributionResult& partial = partial_results[thread_index];
+
+            for (size_t i = begin; i < end; i++) {
+                const GameState state = frontier[i].first.toState(round_index);
+                const double state_probability = frontier[i].second * price_probability;
+
+                // Summed per state first, adding hundreds of millions of tiny terms straight into the totals loses precision
+                OutcomeDistributionResult state_outcomes;
+
+                for (int land_price = Rules::land_price_min; land_price <= Rules::land_price_max; land_price++) {
+                    GameState decided = state;
+                    decided.land_price = land_price;
+                    policy.decide<Rules>(decided);
+
+                    for (const Branch& branch : branches) {
+                        GameState next = decided;
+                        const double probability = state_probability * branch.probability;
+
+                        if (RoundKernel<Rules>::applyRound(next, branch.rolls).game_over) {
+                            state_outcomes.game_over_probability += probability;
+                        }
+                        else if (final_round) {
+                            state_outcomes.grade_probabilities[static_cast<int>(RoundKernel<Rules>::evaluate(next, config_.evaluation_round_index))] += probability;
+                        }
+                        else {
+                            const StateKey key(next);
+                            const uint64_t hash = hashKey(key);
+                            expanded[thread_index][(hash >> 40) % thread_count].add(key, hash, probability);
+                        }
+                    }
+                }
+
+                addOutcomes(state_outcomes, partial);
+            }
+        });
+
+        for (const OutcomeDistributionResult& partial : partial_results) {
+            addOutcomes(partial, result);
+        }
+
+        runOnThreads(thread_count, [&](const int shard) {
+            for (int thread_index = 1; thread_index < thread_count; thread_index++) {
+                expanded[thread_index][shard].mergeInto(expanded[0][shard]);
+                expanded[thread_index][shard] = StateTable();
+            }
+        });
+
+        size_t next_frontier_size = 0;
+        for (int shard = 0; shard < thread_count; shard++) {
+            next_frontier_size += expanded[0][shard].size();
+        }
+
+        std::vector<std::pair<StateKey, double>> next_frontier;
+        next_frontier.reserve(next_frontier_size);
+        for (int shard = 0; shard < thread_count; shard++) {
+            expanded[0][shard].appendTo(next_frontier);
+        }
+        return next_frontier;
+    }
+
+    static std::vector<std::pair<StateKey, double>> resample(std::vector<std::pair<StateKey, double>> frontier,
+        const int max_states, SeededRandom& random) {
+        // Which states the sweep picks depends on their order, a fixed one keeps the thread count out of the result
+        std::sort(frontier.begin(), frontier.end(),
+            [](const std::pair<StateKey, double>& lhs, const std::pair<StateKey, double>& rhs) { return lhs.first < rhs.first; });
+
+        double total = 0.0;
+        for (const std::pair<StateKey, double>& entry : frontier) {
+            total += entry.second;
+        }
+
+        const double stride = total / max_states;
+        double position = stride * random.rollIntInRange(0, kResampleResolution - 1) / kResampleResolution;
+        double cumulative = 0.0;
+
+        std::vector<std::pair<StateKey, double>> resampled;
+        resampled.reserve(max_states);
+        for (const std::pair<StateKey, double>& entry : frontier) {
+            cumulative += entry.second;
+
+            int copies = 0;
+            while (position < cumulative) {
+                copies++;
+                position += stride;
+            }
+            if (copies > 0) {
+                resampled.push_back(std::make_pair(entry.first, copies * stride));
+            }
+        }
+        return resampled;
+    }
+
+    static void addOutcomes(const OutcomeDistributionResult& from, OutcomeDistributionResult& to) {
+        for (int grade = 0; grade <= static_cast<int>(PerformanceGrade::Excellent); grade++) {
+            to.grade_probabilities[grade] += from.grade_probabilities[grade];
+        }
+        to.game_over_probability += from.game_over_probability;
+    }
+
+    template <typename Worker>
+    static void runOnThreads(const int thread_count, const Worker& worker) {
+        std::vector<std::thread> threads;
+        for (int t = 1; t < thread_count; t++) {
+            threads.emplace_back(worker, t);
+        }
+        worker(0);
+
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    static constexpr int kMinStatesPerThread = 64;
+    static constexpr int kResampleResolution = 1 << 30;
+};
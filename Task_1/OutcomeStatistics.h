@@ -0,0 +1,210 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "GameState.h"
+#include "RoundKernel.h"
+
+// Fixed size log-linear histogram in the spirit of HdrHistogram.
+// Values below 128 get their own bucket, every power of two above that is split into 64 buckets,
+// so a reported percentile is within 1/64 of the true value. Buckets are relaxed atomics with a
+// single writer, which lets other threads merge or read percentiles while it is being filled.
+class LogLinearHistogram {
+public:
+    static constexpr int kLinearBuckets = 128;
+    static constexpr int kSubBuckets = 64;
+    static constexpr int kMaxExponent = 31;
+    static constexpr int kBucketCount = kLinearBuckets + (kMaxExponent - 6) * kSubBuckets;
+
+    LogLinearHistogram() {
+        for (std::atomic<uint64_t>& count : counts_) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Only the owning thread may record
+    void record(const int64_t value) {
+        std::atomic<uint64_t>& count = counts_[bucketIndex(value)];
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void merge(const LogLinearHistogram& other) {
+        for (int i = 0; i < kBucketCount; i++) {
+            const uint64_t other_count = other.counts_[i].load(std::memory_order_relaxed);
+            if (other_count != 0) {
+                counts_[i].fetch_add(other_count, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    uint64_t totalCount() const {
+        uint64_t total = 0;
+        for (const std::atomic<uint64_t>& count : counts_) {
+            total += count.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // quantile in [0, 1], e.g. 0.999 for p999
+    int64_t valueAtQuantile(const double quantile) const {
+        const uint64_t total = totalCount();
+        if (total == 0) {
+            return 0;
+        }
+
+        const double clamped_quantile = quantile < 0.0 ? 0.0 : (quantile > 1.0 ? 1.0 : quantile);
+        uint64_t rank = static_cast<uint64_t>(clamped_quantile * static_cast<double>(total) + 0.5);
+        rank = rank == 0 ? 1 : (rank > total ? total : rank);
+
+        uint64_t seen = 0;
+        for (int i = 0; i < kBucketCount; i++) {
+            seen += counts_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return bucketMidpoint(i);
+            }
+        }
+        return bucketMidpoint(kBucketCount - 1);
+    }
+
+    static int bucketIndex(const int64_t value) {
+        if (value < kLinearBuckets) {
+            return value < 0 ? 0 : static_cast<int>(value);
+        }
+
+        int exponent = 7;
+        while (exponent < kMaxExponent && (value >> (exponent + 1)) != 0) {
+            exponent++;
+        }
+        if ((value >> (exponent + 1)) != 0) {
+            return kBucketCount - 1;
+        }
+
+        const int shift = exponent - 6;
+        return kLinearBuckets + (exponent - 7) * kSubBuckets + static_cast<int>((value >> shift) - kSubBuckets);
+    }
+
+    static int64_t bucketLowerBound(const int index) {
+        if (index < kLinearBuckets) {
+            return index;
+        }
+
+        const int exponent = 7 + (index - kLinearBuckets) / kSubBuckets;
+        const int64_t sub_bucket = kSubBuckets + (index - kLinearBuckets) % kSubBuckets;
+        return sub_bucket << (exponent - 6);
+    }
+
+private:
+    std::atomic<uint64_t> counts_[kBucketCount];
+
+    static int64_t bucketMidpoint(const int index) {
+        if (index < kLinearBuckets) {
+            return index;
+        }
+        const int exponent = 7 + (index - kLinearBuckets) / kSubBuckets;
+        return bucketLowerBound(index) + ((int64_t(1) << (exponent - 6)) - 1) / 2;
+    }
+};
+
+enum class OutcomeMetric {
+    FinalPopulation,
+    PeopleDiedTotally,
+    WheatAmount,
+    LandAmount,
+    Count
+};
+
+// End of game statistics for one writer thread. Merge shards into a fresh instance to read them.
+class alignas(64) OutcomeStatistics {
+public:
+    OutcomeStatistics() {
+        for (std::atomic<uint64_t>& count : grade_counts_) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        game_overs_.store(0, std::memory_order_relaxed);
+    }
+
+    void recordEvaluatedGame(const GameState& state, const PerformanceGrade grade) {
+        histograms_[static_cast<int>(OutcomeMetric::FinalPopulation)].record(state.population);
+        histograms_[static_cast<int>(OutcomeMetric::PeopleDiedTotally)].record(state.people_died_totally);
+        histograms_[static_cast<int>(OutcomeMetric::WheatAmount)].record(state.wheat_amount);
+        histograms_[static_cast<int>(OutcomeMetric::LandAmount)].record(state.land_amount);
+
+        std::atomic<uint64_t>& grade_count = grade_counts_[static_cast<int>(grade)];
+        grade_count.store(grade_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void recordGameOver() {
+        game_overs_.store(game_overs_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void merge(const OutcomeStatistics& other) {
+        for (int metric = 0; metric < metricCount(); metric++) {
+            histograms_[metric].merge(other.histograms_[metric]);
+        }
+        for (int grade = 0; grade < kGradeCount; grade++) {
+            grade_counts_[grade].fetch_add(other.grade_counts_[grade].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        game_overs_.fetch_add(other.game_overs_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    const LogLinearHistogram& histogram(const OutcomeMetric metric) const {
+        return histograms_[static_cast<int>(metric)];
+    }
+
+    uint64_t gradeCount(const PerformanceGrade grade) const {
+        return grade_counts_[static_cast<int>(grade)].load(std::memory_order_relaxed);
+    }
+
+    uint64_t gameOverCount() const {
+        return game_overs_.load(std::memory_order_relaxed);
+    }
+
+    void printSummary(std::ostream& out) const {
+        static const char* metric_names[] = { "Population", "Deaths", "Wheat", "Land" };
+
+        out << "Games evaluated: " << histograms_[0].totalCount() << ", game overs: " << gameOverCount() << "\n";
+        for (int metric = 0; metric < metricCount(); metric++) {
+            out << metric_names[metric]
+                << " p50 " << histograms_[metric].valueAtQuantile(0.5)
+                << " p99 " << histograms_[metric].valueAtQuantile(0.99)
+                << " p999 " << histograms_[metric].valueAtQuantile(0.999) << "\n";
+        }
+    }
+
+private:
+    static constexpr int kGradeCount = static_cast<int>(PerformanceGrade::Excellent) + 1;
+
+    LogLinearHistogram histograms_[static_cast<int>(OutcomeMetric::Count)];
+    std::atomic<uint64_t> grade_counts_[kGradeCount];
+    std::atomic<uint64_t> game_overs_;
+
+    static constexpr int metricCount() {
+        return static_cast<int>(OutcomeMetric::Count);
+    }
+};
+
+// One OutcomeStatistics per writer thread. snapshot() can run at any time from any thread.
+class OutcomeStatisticsShards {
+public:
+    explicit OutcomeStatisticsShards(const int shard_count) : shards_(shard_count) {}
+
+    OutcomeStatistics& shard(const int index) {
+        return shards_[index];
+    }
+
+    int shardCount() const {
+        return static_cast<int>(shards_.size());
+    }
+
+    void snapshot(OutcomeStatistics& target) const {
+        for (const OutcomeStatistics& shard : shards_) {
+            target.merge(shard);
+        }
+    }
+
+private:
+    std::vector<OutcomeStatistics> shards_;
+};
@@ -0,0 +1,411 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BotPolicy.h"
+#include "GameState.h"
+#include "OutcomeStatistics.h"
+#include "RoundKernel.h"
+
+struct OptimizerConfig {
+    int population_size = 16;
+    int games_per_candidate = 200;
+    int evaluation_round_index = 10;
+    int thread_count = 0;
+    uint64_t seed = 1;
+    std::string checkpoint_path = "optimizer_checkpoint.txt";
+
+    double grade_weight = 100.0;
+    double death_weight = 1.0;
+    double game_over_penalty = 1000.0;
+};
+
+// Tunes BotPolicy with a separable CMA-ES (diagonal covariance) over the normalized parameter cube.
+// A generation's candidates are scored in parallel, all of them on the same seeded games
+// (common random numbers), so fitness differences come from the policies and not from luck.
+template <typename Rules>
+class PolicyOptimizer {
+public:
+    static constexpr int kDimensions = BotPolicy::kParameterCount;
+
+    PolicyOptimizer(const OptimizerConfig& config) : PolicyOptimizer(config, true) {}
+
+    // Best policy of the checkpoint written with these settings, read without the messages of a resumed run.
+    // Returns false when the checkpoint is missing, damaged or from other settings.
+    static bool loadBestPolicy(const OptimizerConfig& config, BotPolicy& policy) {
+        const PolicyOptimizer optimizer(config, false);
+        if (!optimizer.resumed_) {
+            return false;
+        }
+        policy = optimizer.bestPolicy();
+        return true;
+    }
+
+    // False when the search started from scratch, because the checkpoint was missing, damaged or from other settings
+    bool resumedFromCheckpoint() const {
+        return resumed_;
+    }
+
+    void run(const int generations) {
+        for (int i = 0; i < generations; i++) {
+            runGeneration();
+            saveCheckpoint(config_.checkpoint_path);
+
+            std::cout
+                << "Generation " << generation_
+                << ": best " << generation_best_fitness_
+                << ", overall best " << best_fitness_
+                << ", sigma " << sigma_ << "\n";
+
+            if (statistics_ != nullptr) {
+                OutcomeStatistics snapshot;
+                statistics_->snapshot(snapshot);
+                snapshot.printSummary(std::cout);
+            }
+        }
+        std::cout << std::flush;
+    }
+
+    // Every game played by the workers is recorded into the shard of its thread, shards are single writer
+    // so there has to be one per worker thread
+    void attachOutcomeStatistics(OutcomeStatisticsShards* statistics) {
+        assert(statistics == nullptr || statistics->shardCount() >= config_.thread_count);
+        statistics_ = statistics;
+    }
+
+    int threadCount() const {
+        return config_.thread_count;
+    }
+
+    BotPolicy bestPolicy() const {
+        return BotPolicy::fromNormalized<Rules>(best_x_);
+    }
+
+    // Score of the best policy on the games of the latest generation
+    double bestFitness() const {
+        return best_fitness_;
+    }
+
+    // Mean score of the policy over the games seeded from first_game_seed onwards
+    double evaluatePolicy(const BotPolicy& policy, const uint64_t first_game_seed, OutcomeStatistics* statistics = nullptr) const {
+        double score = 0.0;
+
+        for (int game = 0; game < config_.games_per_candidate; game++) {
+            SeededRandom random(first_game_seed + static_cast<uint64_t>(game));
+            bool game_over;
+            const GameState state = policy.play<Rules>(random, config_.evaluation_round_index, game_over);
+
+            if (game_over) {
+                score -= config_.game_over_penalty;
+                if (statistics != nullptr) {
+                    statistics->recordGameOver();
+                }
+                continue;
+            }
+
+            const PerformanceGrade grade = RoundKernel<Rules>::evaluate(state, config_.evaluation_round_index);
+            if (statistics != nullptr) {
+                statistics->recordEvaluatedGame(state, grade);
+            }
+            score += config_.grade_weight * static_cast<int>(grade) - config_.death_weight * state.people_died_totally;
+        }
+
+        return score / config_.games_per_candidate;
+    }
+
+private:
+    OptimizerConfig config_;
+    OutcomeStatisticsShards* statistics_ = nullptr;
+    bool resumed_ = false;
+
+    // Strategy parameters, fixed by the population size
+    int mu_ = 0;
+    std::vector<double> weights_;
+    double mueff_ = 0.0;
+    double cs_ = 0.0;
+    double ds_ = 0.0;
+    double cc_ = 0.0;
+    double c1_ = 0.0;
+    double cmu_ = 0.0;
+    double chi_n_ = 0.0;
+
+    static constexpr double kNoFitness = -1e300;
+
+    // Search state, this is what the checkpoint holds
+    int generation_ = 0;
+    double sigma_ = 0.3;
+    double mean_[kDimensions];
+    double covariance_[kDimensions];
+    double sigma_path_[kDimensions];
+    double covariance_path_[kDimensions];
+    double best_x_[kDimensions];
+    double best_fitness_ = kNoFitness;
+    double generation_best_fitness_ = kNoFitness;
+
+    PolicyOptimizer(const OptimizerConfig& config, const bool report_checkpoint) {
+        config_ = config;
+        if (config_.thread_count <= 0) {
+            config_.thread_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        }
+
+        initializeStrategyParameters();
+        resetSearchState();
+
+        resumed_ = loadCheckpoint(config_.checkpoint_path, report_checkpoint);
+        if (resumed_ && report_checkpoint) {
+            std::cout << "Resuming optimization from generation " << generation_ << "." << std::endl;
+        }
+    }
+
+    void initializeStrategyParameters() {
+        const double n = kDimensions;
+        const int lambda = std::max(4, config_.population_size);
+        mu_ = lambda / 2;
+
+        weights_.resize(mu_);
+        double weight_sum = 0.0;
+        for (int i = 0; i < mu_; i++) {
+            weights_[i] = std::log(mu_ + 0.5) - std::log(i + 1.0);
+            weight_sum += weights_[i];
+        }
+
+        double weight_square_sum = 0.0;
+        for (double& weight : weights_) {
+            weight /= weight_sum;
+            weight_square_sum += weight * weight;
+        }
+        mueff_ = 1.0 / weight_square_sum;
+
+        cs_ = (mueff_ + 2.0) / (n + mueff_ + 5.0);
+        ds_ = 1.0 + 2.0 * std::max(0.0, std::sqrt((mueff_ - 1.0) / (n + 1.0)) - 1.0) + cs_;
+        cc_ = (4.0 + mueff_ / n) / (n + 4.0 + 2.0 * mueff_ / n);
+
+        // The diagonal model learns faster than the full one, hence the (n + 2) / 3 boost
+        const double diagonal_boost = (n + 2.0) / 3.0;
+        c1_ = std::min(1.0, diagonal_boost * 2.0 / ((n + 1.3) * (n + 1.3) + mueff_));
+        cmu_ = std::min(1.0 - c1_, diagonal_boost * 2.0 * (mueff_ - 2.0 + 1.0 / mueff_) / ((n + 2.0) * (n + 2.0) + mueff_));
+        chi_n_ = std::sqrt(n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+    }
+
+    void resetSearchState() {
+        generation_ = 0;
+        sigma_ = 0.3;
+        for (int d = 0; d < kDimensions; d++) {
+            mean_[d] = 0.5;
+            covariance_[d] = 1.0;
+            sigma_path_[d] = 0.0;
+            covariance_path_[d] = 0.0;
+            best_x_[d] = 0.5;
+        }
+        best_fitness_ = kNoFitness;
+    }
+
+    void runGeneration() {
+        const int lambda = std::max(4, config_.population_size);
+        std::vector<double> steps(static_cast<size_t>(lambda) * kDimensions);
+        std::vector<double> candidates(static_cast<size_t>(lambda) * kDimensions);
+        std::vector<double> fitness(lambda);
+
+        // Seeding the sampler by generation keeps a resumed run identical to an uninterrupted one
+        std::mt19937_64 sampler(config_.seed * 1000003ULL + static_cast<uint64_t>(generation_));
+        std::normal_distribution<double> normal(0.0, 1.0);
+
+        for (int k = 0; k < lambda; k++) {
+            for (int d = 0; d < kDimensions; d++) {
+                const double step = std::sqrt(covariance_[d]) * normal(sampler);
+                steps[k * kDimensions + d] = step;
+                candidates[k * kDimensions + d] = mean_[d] + sigma_ * step;
+            }
+        }
+
+        const uint64_t first_game_seed = config_.seed + static_cast<uint64_t>(generation_) * config_.games_per_candidate;
+        evaluateCandidates(candidates, first_game_seed, fitness);
+
+        std::vector<int> order(lambda);
+        for (int k = 0; k < lambda; k++) {
+            order[k] = k;
+        }
+        std::sort(order.begin(), order.end(), [&fitness](const int a, const int b) { return fitness[a] > fitness[b]; });
+
+        // Every generation plays other games, so the incumbent is scored again on this generation's
+        // before the comparison; a score from easier games would otherwise stay ahead for good
+        if (best_fitness_ > kNoFitness) {
+            best_fitness_ = evaluatePolicy(bestPolicy(), first_game_seed);
+        }
+
+        generation_best_fitness_ = fitness[order[0]];
+        if (generation_best_fitness_ > best_fitness_) {
+            best_fitness_ = generation_best_fitness_;
+            for (int d = 0; d < kDimensions; d++) {
+                best_x_[d] = candidates[order[0] * kDimensions + d];
+            }
+        }
+
+        updateDistribution(steps, order);
+        generation_++;
+    }
+
+    void evaluateCandidates(const std::vector<double>& candidates, const uint64_t first_game_seed, std::vector<double>& fitness) const {
+        std::atomic<int> next_candidate(0);
+        const int candidate_count = static_cast<int>(fitness.size());
+
+        auto worker = [&](const int thread_index) {
+            OutcomeStatistics* statistics = statistics_ == nullptr
+                ? nullptr
+                : &statistics_->shard(thread_index);
+
+            for (int k = next_candidate++; k < candidate_count; k = next_candidate++) {
+                const BotPolicy policy = BotPolicy::fromNormalized<Rules>(&candidates[k * kDimensions]);
+                fitness[k] = evaluatePolicy(policy, first_game_seed, statistics);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int t = 1; t < std::min(config_.thread_count, candidate_count); t++) {
+            threads.emplace_back(worker, t);
+        }
+        worker(0);
+
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    void updateDistribution(const std::vector<double>& steps, const std::vector<int>& order) {
+        double weighted_step[kDimensions] = {};
+        for (int i = 0; i < mu_; i++) {
+            for (int d = 0; d < kDimensions; d++) {
+                weighted_step[d] += weights_[i] * steps[order[i] * kDimensions + d];
+            }
+        }
+
+        double sigma_path_norm = 0.0;
+        for (int d = 0; d < kDimensions; d++) {
+            mean_[d] += sigma_ * weighted_step[d];
+            sigma_path_[d] = (1.0 - cs_) * sigma_path_[d]
+                + std::sqrt(cs_ * (2.0 - cs_) * mueff_) * weighted_step[d] / std::sqrt(covariance_[d]);
+            sigma_path_norm += sigma_path_[d] * sigma_path_[d];
+        }
+        sigma_path_norm = std::sqrt(sigma_path_norm);
+
+        const double path_decay = 1.0 - std::pow(1.0 - cs_, 2.0 * (generation_ + 1));
+        const bool stalled = sigma_path_norm / std::sqrt(path_decay) / chi_n_ >= 1.4 + 2.0 / (kDimensions + 1.0);
+        const double h_sigma = stalled ? 0.0 : 1.0;
+
+        for (int d = 0; d < kDimensions; d++) {
+            covariance_path_[d] = (1.0 - cc_) * covariance_path_[d]
+                + h_sigma * std::sqrt(cc_ * (2.0 - cc_) * mueff_) * weighted_step[d];
+
+            double rank_mu = 0.0;
+            for (int i = 0; i < mu_; i++) {
+                const double step = steps[order[i] * kDimensions + d];
+                rank_mu += weights_[i] * step * step;
+            }
+
+            const double rank_one = covariance_path_[d] * covariance_path_[d]
+                + (1.0 - h_sigma) * cc_ * (2.0 - cc_) * covariance_[d];
+            covariance_[d] = (1.0 - c1_ - cmu_) * covariance_[d] + c1_ * rank_one + cmu_ * rank_mu;
+        }
+
+        sigma_ *= std::exp((cs_ / ds_) * (sigma_path_norm / chi_n_ - 1.0));
+    }
+
+    // Written next to the checkpoint and renamed over it, so an interrupted save never leaves a torn file
+    void saveCheckpoint(const std::string& checkpoint_path) const {
+        const std::string temporary_path = checkpoint_path + ".tmp";
+        {
+            std::ofstream checkpoint_file(temporary_path);
+            if (!checkpoint_file) {
+                std::cerr << "Could not save the optimizer checkpoint." << std::endl;
+                return;
+            }
+
+            checkpoint_file.precision(17);
+            checkpoint_file
+                << config_.seed << " " << config_.population_size << " " << config_.games_per_candidate
+                << " " << config_.evaluation_round_index << "\n";
+            checkpoint_file << generation_ << "\n" << sigma_ << "\n" << best_fitness_ << "\n";
+            writeVector(checkpoint_file, mean_);
+            writeVector(checkpoint_file, covariance_);
+            writeVector(checkpoint_file, sigma_path_);
+            writeVector(checkpoint_file, covariance_path_);
+            writeVector(checkpoint_file, best_x_);
+
+            checkpoint_file.close();
+            if (!checkpoint_file) {
+                std::cerr << "Could not save the optimizer checkpoint." << std::endl;
+                std::remove(temporary_path.c_str());
+                return;
+            }
+        }
+
+        // Windows' rename refuses to replace an existing file
+        if (std::rename(temporary_path.c_str(), checkpoint_path.c_str()) != 0
+            && (std::remove(checkpoint_path.c_str()) != 0 || std::rename(temporary_path.c_str(), checkpoint_path.c_str()) != 0)) {
+            std::cerr << "Could not save the optimizer checkpoint." << std::endl;
+        }
+    }
+
+    bool loadCheckpoint(const std::string& checkpoint_path, const bool report_checkpoint) {
+        std::ifstream checkpoint_file(checkpoint_path);
+        if (!checkpoint_file) {
+            return false;
+        }
+
+        // A checkpoint only resumes the run it came from, other settings would silently mix two searches
+        uint64_t seed = 0;
+        int population_size = 0;
+        int games_per_candidate = 0;
+        int evaluation_round_index = 0;
+        checkpoint_file >> seed >> population_size >> games_per_candidate >> evaluation_round_index;
+        if (checkpoint_file
+            && (seed != config_.seed
+                || population_size != config_.population_size
+                || games_per_candidate != config_.games_per_candidate
+                || evaluation_round_index != config_.evaluation_round_index)) {
+            if (report_checkpoint) {
+                std::cerr << "Optimizer checkpoint was written with different settings. Starting from scratch..." << std::endl;
+            }
+            return false;
+        }
+
+        checkpoint_file >> generation_ >> sigma_ >> best_fitness_;
+        readVector(checkpoint_file, mean_);
+        readVector(checkpoint_file, covariance_);
+        readVector(checkpoint_file, sigma_path_);
+        readVector(checkpoint_file, covariance_path_);
+        readVector(checkpoint_file, best_x_);
+
+        if (!checkpoint_file) {
+            if (report_checkpoint) {
+                std::cerr << "Optimizer checkpoint is damaged. Starting from scratch..." << std::endl;
+            }
+            resetSearchState();
+            return false;
+        }
+        return true;
+    }
+
+    static void writeVector(std::ofstream& file, const double* values) {
+        for (int d = 0; d < kDimensions; d++) {
+            file << values[d] << (d + 1 == kDimensions ? "\n" : " ");
+        }
+    }
+
+    static void readVector(std::ifstream& file, double* values) {
+        for (int d = 0; d < kDimensions; d++) {
+            file >> values[d];
+        }
+    }
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Game.h"
+#include "GameState.h"
+
+// Replays a corpus of scripted sessions without a console.
+// Corpus format: one session per line, "<seed> <answer> <answer> ...", where the answers are exactly
+// what a player would type, quit prompts included. A mistyped answer only costs its own token, like
+// it would in a console where the player retypes it. Every session's transcript is reduced to a
+// 64-bit FNV-1a digest; golden files hold one hexadecimal digest per line in corpus order.
+template <typename Rules>
+class ReplayRunner {
+public:
+    struct ReplaySummary {
+        int sessions = 0;
+        int mismatches = 0;
+        double seconds = 0.0;
+    };
+
+    // Prints one digest per session when golden_path is empty, otherwise reports mismatching sessions
+    static bool run(const std::string& corpus_path, const std::string& golden_path, std::ostream& out) {
+        std::string corpus;
+        if (!readWholeFile(corpus_path, corpus)) {
+            std::cerr << "Corpus " << corpus_path << " not found." << std::endl;
+            return false;
+        }
+
+        std::vector<uint64_t> golden_digests;
+        if (!golden_path.empty() && !readGoldenDigests(golden_path, golden_digests)) {
+            std::cerr << "Golden file " << golden_path << " not found." << std::endl;
+            return false;
+        }
+
+        ReplaySummary summary;
+        std::string report;
+        const auto start = std::chrono::steady_clock::now();
+
+        size_t line_start = 0;
+        while (line_start < corpus.size()) {
+            size_t line_end = corpus.find('\n', line_start);
+            if (line_end == std::string::npos) {
+                line_end = corpus.size();
+            }
+
+            const std::string session = corpus.substr(line_start, line_end - line_start);
+            line_start = line_end + 1;
+            if (session.find_first_not_of(" \t\r") == std::string::npos) {
+                continue;
+            }
+
+            uint64_t digest = 0;
+            if (!replaySession(session, digest)) {
+                report += "Session " + std::to_string(summary.sessions + 1) + " is malformed: it has to start with a seed\n";
+                summary.mismatches++;
+            }
+            else if (golden_path.empty()) {
+                report += toHex(digest) + "\n";
+            }
+            else if (summary.sessions >= static_cast<int>(golden_digests.size()) || golden_digests[summary.sessions] != digest) {
+                report += "Session " + std::to_string(summary.sessions + 1) + " mismatch: " + toHex(digest) + "\n";
+                summary.mismatches++;
+            }
+            summary.sessions++;
+        }
+
+        if (!golden_path.empty() && summary.sessions != static_cast<int>(golden_digests.size())) {
+            report += "Corpus has " + std::to_string(summary.sessions) + " sessions, golden file has "
+                + std::to_string(golden_digests.size()) + "\n";
+            summary.mismatches++;
+        }
+
+        summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        out << report;
+        if (!golden_path.empty()) {
+            out << "Replayed " << summary.sessions << " sessions in " << summary.seconds << " s, "
+                << summary.mismatches << " mismatches.\n";
+        }
+        out.flush();
+
+        return summary.mismatches == 0;
+    }
+
+    // Returns false when the session doesn't start with a seed
+    static bool replaySession(const std::string& session, uint64_t& digest) {
+        std::istringstream input(session);
+        std::ostringstream transcript;
+
+        GameConfig config("", 10);
+        if (!(input >> config.random_seed)) {
+            return false;
+        }
+
+        Game<Rules> game(config, input, transcript);
+        while (game.processRoundTick()) {
+        }
+
+        digest = fnv1a(transcript.str());
+        return true;
+    }
+
+private:
+    static bool readWholeFile(const std::string& path, std::string& contents) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+
+        file.seekg(0, std::ios::end);
+        contents.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0, std::ios::beg);
+        file.read(&contents[0], static_cast<std::streamsize>(contents.size()));
+        return true;
+    }
+
+    static bool readGoldenDigests(const std::string& path, std::vector<uint64_t>& digests) {
+        std::ifstream file(path);
+        if (!file) {
+            return false;
+        }
+
+        uint64_t digest;
+        while (file >> std::hex >> digest) {
+            digests.push_back(digest);
+        }
+        return true;
+    }
+
+    static uint64_t fnv1a(const std::string& text) {
+        uint64_t hash = 0xCBF29CE484222325ULL;
+        for (const char c : text) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 0x100000001B3ULL;
+        }
+        return hash;
+    }
+
+    static std::string toHex(const uint64_t value) {
+        std::ostringstream hex;
+        hex << std::hex << std::setw(16) << std::setfill('0') << value;
+        return hex.str();
+    }
+};
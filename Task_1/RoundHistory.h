@@ -0,0 +1,314 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "GameState.h"
+
+enum class HistoryColumn {
+    Population,
+    LandAmount,
+    WheatAmount,
+    PeopleDied,
+    PeopleArrived,
+    LandPrice,
+    PlagueMultiplier,
+    WheatPerAcre,
+    WheatLost,
+    LandBought,
+    LandSold,
+    WheatConsumed,
+    WheatSown,
+    PeopleDiedTotally,
+    Count
+};
+
+// Columnar store of per-round game histories.
+// Sessions are grouped into blocks of kBlockSessions lanes. Inside a block every
+// (column, round) pair is frame-of-reference bit-packed across lanes; columns that
+// drift from round to round are stored as deltas against the previous round.
+// Queries walk the packed words directly and never materialize GameState rows.
+class RoundHistoryStore {
+public:
+    static constexpr int kBlockSessions = 128;
+
+    explicit RoundHistoryStore(const int max_rounds = 10) : max_rounds_(max_rounds) {
+        staging_.assign(static_cast<size_t>(columnCount()) * max_rounds_ * kBlockSessions, 0);
+    }
+
+    // Rounds are keyed by their position in the history, a session resumed from a save starts at round 0.
+    void appendSession(const std::vector<GameState>& rounds) {
+        const int round_count = std::min(static_cast<int>(rounds.size()), max_rounds_);
+        const int lane = staged_sessions_;
+
+        staged_rounds_played_[lane] = round_count;
+        for (int column = 0; column < columnCount(); column++) {
+            for (int round = 0; round < max_rounds_; round++) {
+                // Rounds past the end repeat the last value so delta runs stay narrow
+                const int source_round = std::min(round, round_count - 1);
+                stagingAt(column, round, lane) = source_round < 0
+                    ? 0
+                    : columnValue(rounds[source_round], static_cast<HistoryColumn>(column));
+            }
+        }
+
+        staged_sessions_++;
+        if (staged_sessions_ == kBlockSessions) {
+            sealOpenBlock();
+        }
+    }
+
+    // Queries only see sealed blocks, call flush() once recording is done.
+    void flush() {
+        if (staged_sessions_ > 0) {
+            sealOpenBlock();
+        }
+    }
+
+    int64_t sessionCount() const {
+        int64_t sessions = 0;
+        for (const Block& block : blocks_) {
+            sessions += block.session_count;
+        }
+        return sessions;
+    }
+
+    size_t compressedBytes() const {
+        size_t bytes = 0;
+        for (const Block& block : blocks_) {
+            bytes += block.words.size() * sizeof(uint64_t) + block.runs.size() * sizeof(PackedRun);
+        }
+        return bytes;
+    }
+
+    // Mean of a column at the given round over sessions that lasted at least round + 1 rounds.
+    double meanAtRound(const HistoryColumn column, const int round) const {
+        if (round < 0 || round >= max_rounds_) {
+            return 0.0;
+        }
+
+        int64_t sum = 0;
+        int64_t sessions = 0;
+        int64_t lane_values[kBlockSessions];
+        int64_t rounds_played[kBlockSessions];
+
+        for (const Block& block : blocks_) {
+            unpackRun(block, block.rounds_played, rounds_played);
+
+            // Only delta columns need the rounds before to rebuild their running value
+            for (int r = isDeltaEncoded(column) ? 0 : round; r <= round; r++) {
+                decodeRound(block, column, r, lane_values);
+            }
+
+            for (int lane = 0; lane < block.session_count; lane++) {
+                const bool reached = rounds_played[lane] > round;
+                sum += reached ? lane_values[lane] : 0;
+                sessions += reached ? 1 : 0;
+            }
+        }
+
+        return sessions == 0 ? 0.0 : static_cast<double>(sum) / static_cast<double>(sessions);
+    }
+
+    // Number of sessions in which the column took the given value in at least min_occurrences rounds,
+    // e.g. countSessionsWithOccurrences(HistoryColumn::PlagueMultiplier, 1, 2) for "plague hit twice".
+    int64_t countSessionsWithOccurrences(const HistoryColumn column, const int64_t value, const int min_occurrences) const {
+        int64_t matched = 0;
+        int64_t lane_values[kBlockSessions];
+        int64_t rounds_played[kBlockSessions];
+        int occurrences[kBlockSessions];
+
+        for (const Block& block : blocks_) {
+            unpackRun(block, block.rounds_played, rounds_played);
+            std::fill(occurrences, occurrences + kBlockSessions, 0);
+
+            for (int round = 0; round < max_rounds_; round++) {
+                decodeRound(block, column, round, lane_values);
+                for (int lane = 0; lane < kBlockSessions; lane++) {
+                    occurrences[lane] += (lane_values[lane] == value && rounds_played[lane] > round) ? 1 : 0;
+                }
+            }
+
+            for (int lane = 0; lane < block.session_count; lane++) {
+                matched += occurrences[lane] >= min_occurrences ? 1 : 0;
+            }
+        }
+
+        return matched;
+    }
+
+    static int columnValue(const GameState& state, const HistoryColumn column) {
+        switch (column) {
+        case HistoryColumn::Population: return state.population;
+        case HistoryColumn::LandAmount: return state.land_amount;
+        case HistoryColumn::WheatAmount: return state.wheat_amount;
+        case HistoryColumn::PeopleDied: return state.people_died;
+        case HistoryColumn::PeopleArrived: return state.people_arrived;
+        case HistoryColumn::LandPrice: return state.land_price;
+        case HistoryColumn::PlagueMultiplier: return state.plague_multiplier;
+        case HistoryColumn::WheatPerAcre: return state.wheat_per_acre;
+        case HistoryColumn::WheatLost: return state.wheat_lost;
+        case HistoryColumn::LandBought: return state.land_bought;
+        case HistoryColumn::LandSold: return state.land_sold;
+        case HistoryColumn::WheatConsumed: return state.wheat_consumed;
+        case HistoryColumn::WheatSown: return state.wheat_sown;
+        case HistoryColumn::PeopleDiedTotally: return state.people_died_totally;
+        default: return 0;
+        }
+    }
+
+private:
+    struct PackedRun {
+        int64_t base = 0;
+        uint32_t word_offset = 0;
+        uint8_t bit_width = 0;
+    };
+
+    struct Block {
+        int session_count = 0;
+        PackedRun rounds_played;
+        std::vector<PackedRun> runs;
+        std::vector<uint64_t> words;
+    };
+
+    int max_rounds_;
+    std::vector<Block> blocks_;
+
+    std::vector<int64_t> staging_;
+    int64_t staged_rounds_played_[kBlockSessions] = {};
+    int staged_sessions_ = 0;
+
+    static constexpr int columnCount() {
+        return static_cast<int>(HistoryColumn::Count);
+    }
+
+    // Accumulating columns compress better as round-to-round deltas, the rest are packed as is
+    static bool isDeltaEncoded(const HistoryColumn column) {
+        return column == HistoryColumn::Population
+            || column == HistoryColumn::LandAmount
+            || column == HistoryColumn::WheatAmount
+            || column == HistoryColumn::PeopleDiedTotally;
+    }
+
+    int64_t& stagingAt(const int column, const int round, const int lane) {
+        return staging_[(static_cast<size_t>(column) * max_rounds_ + round) * kBlockSessions + lane];
+    }
+
+    const PackedRun& runAt(const Block& block, const HistoryColumn column, const int round) const {
+        return block.runs[static_cast<size_t>(column) * max_rounds_ + round];
+    }
+
+    static int bitWidth(uint64_t range) {
+        int width = 0;
+        while (range != 0) {
+            width++;
+            range >>= 1;
+        }
+        return width;
+    }
+
+    static PackedRun packRun(const int64_t* values, std::vector<uint64_t>& words) {
+        int64_t min_value = values[0];
+        int64_t max_value = values[0];
+        for (int lane = 1; lane < kBlockSessions; lane++) {
+            min_value = std::min(min_value, values[lane]);
+            max_value = std::max(max_value, values[lane]);
+        }
+
+        PackedRun run;
+        run.base = min_value;
+        run.word_offset = static_cast<uint32_t>(words.size());
+        run.bit_width = static_cast<uint8_t>(bitWidth(static_cast<uint64_t>(max_value - min_value)));
+
+        const int width = run.bit_width;
+        words.resize(words.size() + (static_cast<size_t>(width) * kBlockSessions + 63) / 64, 0);
+        uint64_t* packed = words.data() + run.word_offset;
+
+        for (int lane = 0; lane < kBlockSessions && width > 0; lane++) {
+            const uint64_t offset_value = static_cast<uint64_t>(values[lane] - min_value);
+            const int bit_position = lane * width;
+            const int word = bit_position >> 6;
+            const int shift = bit_position & 63;
+
+            packed[word] |= offset_value << shift;
+            if (shift + width > 64) {
+                packed[word + 1] |= offset_value >> (64 - shift);
+            }
+        }
+
+        return run;
+    }
+
+    static void unpackRun(const Block& block, const PackedRun& run, int64_t* values) {
+        const int width = run.bit_width;
+        if (width == 0) {
+            std::fill(values, values + kBlockSessions, run.base);
+            return;
+        }
+
+        const uint64_t* packed = block.words.data() + run.word_offset;
+        const uint64_t mask = width == 64 ? ~0ULL : (1ULL << width) - 1;
+
+        for (int lane = 0; lane < kBlockSessions; lane++) {
+            const int bit_position = lane * width;
+            const int word = bit_position >> 6;
+            const int shift = bit_position & 63;
+
+            uint64_t offset_value = packed[word] >> shift;
+            if (shift + width > 64) {
+                offset_value |= packed[word + 1] << (64 - shift);
+            }
+            values[lane] = run.base + static_cast<int64_t>(offset_value & mask);
+        }
+    }
+
+    // Rounds of a delta column must be decoded in order, lane_values carries the running value
+    void decodeRound(const Block& block, const HistoryColumn column, const int round, int64_t* lane_values) const {
+        if (!isDeltaEncoded(column) || round == 0) {
+            unpackRun(block, runAt(block, column, round), lane_values);
+            return;
+        }
+
+        int64_t deltas[kBlockSessions];
+        unpackRun(block, runAt(block, column, round), deltas);
+        for (int lane = 0; lane < kBlockSessions; lane++) {
+            lane_values[lane] += deltas[lane];
+        }
+    }
+
+    void sealOpenBlock() {
+        Block block;
+        block.session_count = staged_sessions_;
+        block.runs.resize(static_cast<size_t>(columnCount()) * max_rounds_);
+
+        // Unused lanes of a partial block copy lane 0 so they do not widen the packing
+        for (int lane = staged_sessions_; lane < kBlockSessions; lane++) {
+            staged_rounds_played_[lane] = 0;
+            for (int column = 0; column < columnCount(); column++) {
+                for (int round = 0; round < max_rounds_; round++) {
+                    stagingAt(column, round, lane) = stagingAt(column, round, 0);
+                }
+            }
+        }
+
+        block.rounds_played = packRun(staged_rounds_played_, block.words);
+
+        int64_t encoded[kBlockSessions];
+        for (int column = 0; column < columnCount(); column++) {
+            const bool delta = isDeltaEncoded(static_cast<HistoryColumn>(column));
+            for (int round = 0; round < max_rounds_; round++) {
+                for (int lane = 0; lane < kBlockSessions; lane++) {
+                    encoded[lane] = delta && round > 0
+                        ? stagingAt(column, round, lane) - stagingAt(column, round - 1, lane)
+                        : stagingAt(column, round, lane);
+                }
+                block.runs[static_cast<size_t>(column) * max_rounds_ + round] = packRun(encoded, block.words);
+            }
+        }
+
+        blocks_.push_back(std::move(block));
+        staged_sessions_ = 0;
+    }
+};
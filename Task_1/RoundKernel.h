@@ -0,0 +1,124 @@
+#pragma once
+
+#include <climits>
+
+#include "GameState.h"
+#include "Rules.h"
+
+struct RoundRolls {
+    int wheat_per_acre = 0;
+    int wheat_lost_percentage = 0;
+    int plague_roll = 0;
+};
+
+struct RoundResult {
+    bool game_over = false;
+    int mortality_rate = 0;
+};
+
+enum class PerformanceGrade {
+    Bad,
+    Satisfactory,
+    Good,
+    Excellent
+};
+
+// Console free round logic shared by Game and the headless tools.
+// All random draws are passed in explicitly, so callers decide where they come from.
+template <typename Rules>
+class RoundKernel {
+public:
+    template <typename Random>
+    static int rollLandPrice(Random& random) {
+        return random.rollIntInRange(Rules::land_price_min, Rules::land_price_max);
+    }
+
+    template <typename Random>
+    static RoundRolls rollRound(Random& random) {
+        RoundRolls rolls;
+        rolls.wheat_per_acre = random.rollIntInRange(Rules::wheat_per_acre_min, Rules::wheat_per_acre_max);
+        rolls.wheat_lost_percentage = random.rollIntInRange(Rules::rats_loss_percent_min, Rules::rats_loss_percent_max);
+        rolls.plague_roll = random.rollIntInRange(0, Rules::plague_roll_max);
+        return rolls;
+    }
+
+    // Applies the player's decisions stored in state together with the round's draws.
+    // On game over the state is left as it was at the moment of the check.
+    static RoundResult applyRound(GameState& state, const RoundRolls& rolls) {
+        RoundResult result;
+        state.round_index++;
+
+        // Process land purchase
+        state.land_amount += state.land_bought;
+        state.wheat_amount -= state.land_bought * state.land_price;
+
+        // Process land sale
+        state.land_amount -= state.land_sold;
+        state.wheat_amount += state.land_sold * state.land_price;
+
+        // Collect sown wheat
+        state.wheat_per_acre = rolls.wheat_per_acre;
+        const int available_sown_land_amount = MathUtils::clamp(state.wheat_sown * Rules::acres_per_sown_wheat, 0, state.land_amount);
+        const int processed_sown_land_amount = MathUtils::clamp(available_sown_land_amount, 0, state.population * Rules::acres_per_worker);
+        state.wheat_amount += processed_sown_land_amount * state.wheat_per_acre;
+
+        // Process wheat loss
+        state.wheat_lost = state.wheat_amount * rolls.wheat_lost_percentage / Rules::rats_loss_divisor;
+        state.wheat_amount -= state.wheat_lost;
+
+        // Calculate survivors, casualties and arrivals
+        const int people_survived_round = MathUtils::clamp(state.wheat_consumed / Rules::wheat_per_person, 0, state.population);
+        state.people_died = state.population - people_survived_round;
+
+        // Force lose if death rate exceeded the cutoff
+        result.mortality_rate = state.population == 0 ? 100 : (state.people_died / state.population) * 100;
+        if (result.mortality_rate >= Rules::game_over_mortality_percent) {
+            result.game_over = true;
+            return result;
+        }
+
+        state.wheat_amount = MathUtils::clamp(state.wheat_amount - people_survived_round * Rules::wheat_per_person, 0, INT_MAX);
+        state.people_died_totally += state.people_died;
+        state.population = people_survived_round;
+
+        state.people_arrived =
+            MathUtils::clamp(state.people_died / Rules::arrival_deaths_divisor * (Rules::arrival_yield_baseline - state.wheat_per_acre)
+                * state.wheat_amount / Rules::arrival_wheat_divisor + Rules::base_arrivals_per_round,
+                0, Rules::max_arrivals_per_round);
+        state.population += state.people_arrived;
+
+        // Process plague
+        state.plague_multiplier = rolls.plague_roll <= Rules::plague_chance_percent ? 1 : 0;
+        state.population /= (state.plague_multiplier + 1);
+
+        return result;
+    }
+
+    static PerformanceGrade evaluate(const GameState& state, const int evaluation_round_index) {
+        const int annual_death_rate = state.people_died_totally / evaluation_round_index;
+        const int acres_per_person = state.population == 0 ? 0 : state.land_amount / state.population;
+
+        if (annual_death_rate > Rules::bad_death_rate && acres_per_person < Rules::bad_acres_per_person) {
+            return PerformanceGrade::Bad;
+        }
+
+        if (annual_death_rate > Rules::satisfactory_death_rate && acres_per_person < Rules::satisfactory_acres_per_person) {
+            return PerformanceGrade::Satisfactory;
+        }
+
+        if (annual_death_rate > Rules::good_death_rate && acres_per_person < Rules::good_acres_per_person) {
+            return PerformanceGrade::Good;
+        }
+
+        return PerformanceGrade::Excellent;
+    }
+
+    static const char* gradeName(const PerformanceGrade grade) {
+        switch (grade) {
+        case PerformanceGrade::Bad: return "Bad.";
+        case PerformanceGrade::Satisfactory: return "Satisfactory.";
+        case PerformanceGrade::Good: return "Good.";
+        default: return "Excellent.";
+        }
+    }
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Default ruleset. Every value is a compile time constant, so Game<DefaultRules>
+// folds them straight into the round kernel.
+struct DefaultRules {
+    static constexpr int land_price_min = 17;
+    static constexpr int land_price_max = 26;
+    static constexpr int wheat_per_acre_min = 1;
+    static constexpr int wheat_per_acre_max = 6;
+    static constexpr int rats_loss_percent_min = 0;
+    static constexpr int rats_loss_percent_max = 7;
+    static constexpr int rats_loss_divisor = 100;
+
+    static constexpr int wheat_per_person = 20;
+    static constexpr int acres_per_worker = 10;
+    static constexpr int acres_per_sown_wheat = 2;
+
+    // arrivals = died / arrival_deaths_divisor * (arrival_yield_baseline - wheat per acre) * wheat / arrival_wheat_divisor
+    //     + base_arrivals_per_round, clamped to [0, max_arrivals_per_round]
+    static constexpr int arrival_deaths_divisor = 2;
+    static constexpr int arrival_yield_baseline = 5;
+    static constexpr int arrival_wheat_divisor = 600;
+    static constexpr int base_arrivals_per_round = 1;
+    static constexpr int max_arrivals_per_round = 50;
+
+    // The plague strikes when a roll in [0, plague_roll_max] is at most plague_chance_percent
+    static constexpr int plague_roll_max = 100;
+    static constexpr int plague_chance_percent = 15;
+    static constexpr int game_over_mortality_percent = 45;
+
+    static constexpr int bad_death_rate = 33;
+    static constexpr int bad_acres_per_person = 7;
+    static constexpr int satisfactory_death_rate = 10;
+    static constexpr int satisfactory_acres_per_person = 9;
+    static constexpr int good_death_rate = 3;
+    static constexpr int good_acres_per_person = 10;
+};
+
+// Ruleset read from a text file at startup, for trying out game variants without rebuilding.
+// The file holds "name value" pairs, names match the DefaultRules fields and missing ones keep their default.
+struct RuntimeRules {
+    static inline int land_price_min = DefaultRules::land_price_min;
+    static inline int land_price_max = DefaultRules::land_price_max;
+    static inline int wheat_per_acre_min = DefaultRules::wheat_per_acre_min;
+    static inline int wheat_per_acre_max = DefaultRules::wheat_per_acre_max;
+    static inline int rats_loss_percent_min = DefaultRules::rats_loss_percent_min;
+    static inline int rats_loss_percent_max = DefaultRules::rats_loss_percent_max;
+    static inline int rats_loss_divisor = DefaultRules::rats_loss_divisor;
+
+    static inline int wheat_per_person = DefaultRules::wheat_per_person;
+    static inline int acres_per_worker = DefaultRules::acres_per_worker;
+    static inline int acres_per_sown_wheat = DefaultRules::acres_per_sown_wheat;
+
+    static inline int arrival_deaths_divisor = DefaultRules::arrival_deaths_divisor;
+    static inline int arrival_yield_baseline = DefaultRules::arrival_yield_baseline;
+    static inline int arrival_wheat_divisor = DefaultRules::arrival_wheat_divisor;
+    static inline int base_arrivals_per_round = DefaultRules::base_arrivals_per_round;
+    static inline int max_arrivals_per_round = DefaultRules::max_arrivals_per_round;
+
+    static inline int plague_roll_max = DefaultRules::plague_roll_max;
+    static inline int plague_chance_percent = DefaultRules::plague_chance_percent;
+    static inline int game_over_mortality_percent = DefaultRules::game_over_mortality_percent;
+
+    static inline int bad_death_rate = DefaultRules::bad_death_rate;
+    static inline int bad_acres_per_person = DefaultRules::bad_acres_per_person;
+    static inline int satisfactory_death_rate = DefaultRules::satisfactory_death_rate;
+    static inline int satisfactory_acres_per_person = DefaultRules::satisfactory_acres_per_person;
+    static inline int good_death_rate = DefaultRules::good_death_rate;
+    static inline int good_acres_per_person = DefaultRules::good_acres_per_person;
+
+    static bool loadFromFile(const std::string& rules_path) {
+        std::ifstream rules_file(rules_path);
+        if (!rules_file) {
+            std::cerr << "Rules file " << rules_path << " not found." << std::endl;
+            return false;
+        }
+
+        std::string name;
+        int value;
+        while (rules_file >> name >> value) {
+            const NamedField* named_field = findField(name);
+            if (named_field == nullptr) {
+                std::cerr << "Unknown rule: " << name << std::endl;
+                return false;
+            }
+            *named_field->field = value;
+        }
+
+        if (!rules_file.eof()) {
+            std::cerr << "Malformed rules file " << rules_path << std::endl;
+            return false;
+        }
+
+        for (const NamedField& named_field : namedFields()) {
+            if (*named_field.field < named_field.min_value || *named_field.field > named_field.max_value) {
+                std::cerr << "Rule " << named_field.name << " must be in [" << named_field.min_value << ", "
+                    << named_field.max_value << "], got " << *named_field.field << std::endl;
+                return false;
+            }
+        }
+
+        if (land_price_min > land_price_max
+            || wheat_per_acre_min > wheat_per_acre_max
+            || rats_loss_percent_min > rats_loss_percent_max
+            || rats_loss_percent_max > rats_loss_divisor
+            || plague_chance_percent > plague_roll_max) {
+            std::cerr << "Inconsistent rules in " << rules_path << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    struct NamedField {
+        const char* name;
+        int* field;
+        int min_value;
+        int max_value;
+    };
+
+    // Large enough for any sensible variant, small enough that the width of a rolled range,
+    // max - min + 1, and plague_roll_max + 1 can't overflow
+    static constexpr int kMaxRuleValue = 1000000;
+
+    // Limits keep every divisor non-zero and the percentages and ranges meaningful
+    static const std::vector<NamedField>& namedFields() {
+        static const std::vector<NamedField> fields = {
+            { "land_price_min", &land_price_min, 1, kMaxRuleValue },
+            { "land_price_max", &land_price_max, 1, kMaxRuleValue },
+            { "wheat_per_acre_min", &wheat_per_acre_min, 0, kMaxRuleValue },
+            { "wheat_per_acre_max", &wheat_per_acre_max, 0, kMaxRuleValue },
+            { "rats_loss_percent_min", &rats_loss_percent_min, 0, kMaxRuleValue },
+            { "rats_loss_percent_max", &rats_loss_percent_max, 0, kMaxRuleValue },
+            { "rats_loss_divisor", &rats_loss_divisor, 1, kMaxRuleValue },
+            { "wheat_per_person", &wheat_per_person, 1, kMaxRuleValue },
+            { "acres_per_worker", &acres_per_worker, 0, kMaxRuleValue },
+            { "acres_per_sown_wheat", &acres_per_sown_wheat, 1, kMaxRuleValue },
+            { "arrival_deaths_divisor", &arrival_deaths_divisor, 1, kMaxRuleValue },
+            { "arrival_yield_baseline", &arrival_yield_baseline, -kMaxRuleValue, kMaxRuleValue },
+            { "arrival_wheat_divisor", &arrival_wheat_divisor, 1, kMaxRuleValue },
+            { "base_arrivals_per_round", &base_arrivals_per_round, 0, kMaxRuleValue },
+            { "max_arrivals_per_round", &max_arrivals_per_round, 0, kMaxRuleValue },
+            { "plague_roll_max", &plague_roll_max, 0, kMaxRuleValue },
+            { "plague_chance_percent", &plague_chance_percent, 0, 100 },
+            { "game_over_mortality_percent", &game_over_mortality_percent, 0, 100 },
+            { "bad_death_rate", &bad_death_rate, 0, kMaxRuleValue },
+            { "bad_acres_per_person", &bad_acres_per_person, 0, kMaxRuleValue },
+            { "satisfactory_death_rate", &satisfactory_death_rate, 0, kMaxRuleValue },
+            { "satisfactory_acres_per_person", &satisfactory_acres_per_person, 0, kMaxRuleValue },
+            { "good_death_rate", &good_death_rate, 0, kMaxRuleValue },
+            { "good_acres_per_person", &good_acres_per_person, 0, kMaxRuleValue },
+        };
+        return fields;
+    }
+
+    static const NamedField* findField(const std::string& name) {
+        for (const NamedField& named_field : namedFields()) {
+            if (name == named_field.name) {
+                return &named_field;
+            }
+        }
+        return nullptr;
+    }
+};
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Game.h"
+#include "GameState.h"
+
+// What SessionStore::processInput did with a round of answers
+enum class InputResult {
+    Applied,
+    Discarded,
+    Closed
+};
+
+// Hosts many game sessions while keeping at most max_resident_sessions of them in memory.
+// Resident sessions live in a fixed set of frames recycled with the CLOCK policy; evicted ones
+// are written to a slab file of fixed size records, one slot per session id, and read back
+// with a single seek when their next input arrives. Slab file failures throw std::runtime_error,
+// a session that can't be paged in or out would otherwise be lost silently.
+template <typename Rules>
+class SessionStore {
+public:
+    SessionStore(const std::string& slab_path, const int max_resident_sessions, const int evaluation_round_index = 10)
+        : frames_(max_resident_sessions > 0 ? max_resident_sessions : 1) {
+        evaluation_round_index_ = evaluation_round_index;
+        slab_file_.open(slab_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!slab_file_) {
+            throw std::runtime_error("Could not open the session slab file " + slab_path);
+        }
+    }
+
+    // Writes the first round with its price to output, the first processInput answers it
+    int openSession(const uint64_t random_seed, std::ostream& output) {
+        // Claimed first, so a failed eviction doesn't leak a session id
+        const int frame_index = claimFrame();
+
+        int session_id;
+        if (!free_session_ids_.empty()) {
+            session_id = free_session_ids_.back();
+            free_session_ids_.pop_back();
+        }
+        else {
+            session_id = static_cast<int>(page_table_.size());
+            page_table_.push_back(SessionLocation());
+        }
+
+        SessionSnapshot snapshot;
+        snapshot.random_state = random_seed;
+
+        std::istringstream no_input;
+        GameConfig config("", evaluation_round_index_);
+        Game<Rules> game(config, no_input, output);
+        game.restoreSession(snapshot);
+        game.beginRound();
+        snapshot = game.saveSession();
+
+        Frame& frame = frames_[frame_index];
+        frame.session_id = session_id;
+        frame.snapshot = snapshot;
+        frame.referenced = true;
+        frame.dirty = true;
+
+        page_table_[session_id].open = true;
+        page_table_[session_id].frame = frame_index;
+        return session_id;
+    }
+
+    // Feeds the answers for the round shown last ("<quit prompt> <buy> <sell> <consume> <sow>") to the session,
+    // then writes the next round with its price to output. An incomplete round is discarded and leaves the session
+    // and output as they were, the round shown last still awaits its answers. Closed means the player has quit
+    // or the session wasn't open.
+    InputResult processInput(const int session_id, const std::string& input, std::ostream& output) {
+        if (!isOpen(session_id)) {
+            return InputResult::Closed;
+        }
+
+        Frame& frame = frames_[faultIn(session_id)];
+        frame.referenced = true;
+
+        // Buffered, the prompts and complaints of a discarded attempt would mislead the player
+        std::istringstream input_stream(input);
+        std::ostringstream round_output;
+        GameConfig config("", evaluation_round_index_);
+        Game<Rules> game(config, input_stream, round_output);
+        game.restoreSession(frame.snapshot);
+
+        if (!game.finishRound()) {
+            if (game.quitRequested()) {
+                output << round_output.str();
+                closeSession(session_id);
+                return InputResult::Closed;
+            }
+            return InputResult::Discarded;
+        }
+
+        game.beginRound();
+        frame.snapshot = game.saveSession();
+        frame.dirty = true;
+        output << round_output.str();
+        return InputResult::Applied;
+    }
+
+    void closeSession(const int session_id) {
+        if (!isOpen(session_id)) {
+            return;
+        }
+
+        SessionLocation& location = page_table_[session_id];
+        if (location.frame >= 0) {
+            frames_[location.frame] = Frame();
+        }
+        location = SessionLocation();
+        free_session_ids_.push_back(session_id);
+    }
+
+    bool isOpen(const int session_id) const {
+        return session_id >= 0 && session_id < static_cast<int>(page_table_.size()) && page_table_[session_id].open;
+    }
+
+    int residentCount() const {
+        int resident = 0;
+        for (const Frame& frame : frames_) {
+            resident += frame.session_id >= 0 ? 1 : 0;
+        }
+        return resident;
+    }
+
+private:
+    struct Frame {
+        int session_id = -1;
+        bool referenced = false;
+        bool dirty = false;
+        SessionSnapshot snapshot;
+    };
+
+    struct SessionLocation {
+        int frame = -1;
+        bool open = false;
+        bool on_disk = false;
+    };
+
+    static constexpr int kStateFieldCount = 15;
+    static constexpr int kRecordSize = kStateFieldCount * sizeof(int32_t) + sizeof(uint64_t);
+
+    std::vector<Frame> frames_;
+    std::vector<SessionLocation> page_table_;
+    std::vector<int> free_session_ids_;
+    int clock_hand_ = 0;
+    int evaluation_round_index_;
+    std::fstream slab_file_;
+
+    int faultIn(const int session_id) {
+        SessionLocation& location = page_table_[session_id];
+        if (location.frame >= 0) {
+            return location.frame;
+        }
+
+        const int frame_index = claimFrame();
+        Frame& frame = frames_[frame_index];
+        if (!readRecord(session_id, frame.snapshot)) {
+            frame = Frame();
+            throw std::runtime_error("Could not read session " + std::to_string(session_id) + " from the slab file");
+        }
+        frame.session_id = session_id;
+        frame.dirty = false;
+
+        location.frame = frame_index;
+        return frame_index;
+    }
+
+    // CLOCK sweep: referenced frames get a second chance, the first unreferenced one is evicted
+    int claimFrame() {
+        while (true) {
+            Frame& frame = frames_[clock_hand_];
+            const int frame_index = clock_hand_;
+            clock_hand_ = (clock_hand_ + 1) % static_cast<int>(frames_.size());
+
+            if (frame.session_id < 0) {
+                return frame_index;
+            }
+
+            if (frame.referenced) {
+                frame.referenced = false;
+                continue;
+            }
+
+            evict(frame);
+            return frame_index;
+        }
+    }
+
+    void evict(Frame& frame) {
+        SessionLocation& location = page_table_[frame.session_id];
+        if (frame.dirty || !location.on_disk) {
+            // Thrown before anything changes, the session stays resident
+            if (!writeRecord(frame.session_id, frame.snapshot)) {
+                throw std::runtime_error("Could not write session " + std::to_string(frame.session_id) + " to the slab file");
+            }
+            location.on_disk = true;
+        }
+        location.frame = -1;
+        frame = Frame();
+    }
+
+    bool writeRecord(const int session_id, const SessionSnapshot& snapshot) {
+        const GameState& state = snapshot.game_state;
+        const int32_t fields[kStateFieldCount] = {
+            state.round_index, state.population, state.land_amount, state.wheat_amount,
+            state.people_died, state.people_arrived, state.land_price, state.plague_multiplier,
+            state.wheat_per_acre, state.wheat_lost, state.people_died_totally,
+            state.land_bought, state.land_sold, state.wheat_consumed, state.wheat_sown };
+
+        char record[kRecordSize];
+        memcpy(record, fields, sizeof(fields));
+        memcpy(record + sizeof(fields), &snapshot.random_state, sizeof(uint64_t));
+
+        slab_file_.clear();
+        slab_file_.seekp(static_cast<std::streamoff>(session_id) * kRecordSize);
+        slab_file_.write(record, kRecordSize);
+        return static_cast<bool>(slab_file_);
+    }
+
+    bool readRecord(const int session_id, SessionSnapshot& snapshot) {
+        char record[kRecordSize];
+        slab_file_.clear();
+        slab_file_.seekg(static_cast<std::streamoff>(session_id) * kRecordSize);
+        slab_file_.read(record, kRecordSize);
+        if (slab_file_.gcount() != kRecordSize) {
+            return false;
+        }
+
+        int32_t fields[kStateFieldCount];
+        memcpy(fields, record, sizeof(fields));
+        memcpy(&snapshot.random_state, record + sizeof(fields), sizeof(uint64_t));
+
+        GameState& state = snapshot.game_state;
+        state.round_index = fields[0];
+        state.population = fields[1];
+        state.land_amount = fields[2];
+        state.wheat_amount = fields[3];
+        state.people_died = fields[4];
+        state.people_arrived = fields[5];
+        state.land_price = fields[6];
+        state.plague_multiplier = fields[7];
+        state.wheat_per_acre = fields[8];
+        state.wheat_lost = fields[9];
+        state.people_died_totally = fields[10];
+        state.land_bought = fields[11];
+        state.land_sold = fields[12];
+        state.wheat_consumed = fields[13];
+        state.wheat_sown = fields[14];
+        return true;
+    }
+};
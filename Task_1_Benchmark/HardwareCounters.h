@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+struct CounterValues {
+    bool available = false;
+    double cycles = 0.0;
+    double instructions = 0.0;
+    double branch_misses = 0.0;
+    double cache_misses = 0.0;
+
+    double instructionsPerCycle() const {
+        return cycles > 0.0 ? instructions / cycles : 0.0;
+    }
+};
+
+// User space hardware counters of the calling thread, read through perf_event_open.
+// The counters form one group led by the cycle counter, so the kernel schedules them together
+// and instructions per cycle compares counts taken over the same intervals. Without a PMU (most VMs), with a restrictive perf_event_paranoid or on other platforms
+// available() is false and the benchmarks fall back to timing only.
+class HardwareCounters {
+public:
+    HardwareCounters() {
+#ifdef __linux__
+        const uint64_t configs[kCounterCount] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES };
+
+        available_ = true;
+        for (int i = 0; i < kCounterCount && available_; i++) {
+            perf_event_attr attributes = perf_event_attr();
+            attributes.size = sizeof(attributes);
+            attributes.type = PERF_TYPE_HARDWARE;
+            attributes.config = configs[i];
+            // Members follow the leader, only the leader is switched on and off
+            attributes.disabled = i == 0 ? 1 : 0;
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+            attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            const int group_leader = i == 0 ? -1 : descriptors_[0];
+            descriptors_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, group_leader, PERF_FLAG_FD_CLOEXEC));
+            available_ = descriptors_[i] >= 0;
+        }
+#endif
+    }
+
+    ~HardwareCounters() {
+#ifdef __linux__
+        for (const int descriptor : descriptors_) {
+            if (descriptor >= 0) {
+                close(descriptor);
+            }
+        }
+#endif
+    }
+
+    HardwareCounters(const HardwareCounters&) = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+    bool available() const {
+        return available_;
+    }
+
+    void start() {
+#ifdef __linux__
+        if (!available_) {
+            return;
+        }
+        ioctl(descriptors_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(descriptors_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    CounterValues stop() {
+        CounterValues values;
+#ifdef __linux__
+        if (!available_) {
+            return values;
+        }
+
+        ioctl(descriptors_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        // Counter count, time enabled, time running, then one value per counter in opening order.
+        // The group is scheduled as a whole, so one scale factor covers every counter when the kernel had to multiplex.
+        uint64_t reading[3 + kCounterCount] = {};
+        if (read(descriptors_[0], reading, sizeof(reading)) != static_cast<ssize_t>(sizeof(reading))
+            || reading[0] != kCounterCount || reading[2] == 0) {
+            return values;
+        }
+        const double scale = static_cast<double>(reading[1]) / reading[2];
+
+        values.available = true;
+        values.cycles = reading[3] * scale;
+        values.instructions = reading[4] * scale;
+        values.branch_misses = reading[5] * scale;
+        values.cache_misses = reading[6] * scale;
+#endif
+        return values;
+    }
+
+private:
+    static constexpr int kCounterCount = 4;
+
+    bool available_ = false;
+    int descriptors_[kCounterCount] = { -1, -1, -1, -1 };
+};
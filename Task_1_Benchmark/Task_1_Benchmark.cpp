@@ -0,0 +1,313 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../Task_1/Game.h"
+#include "../Task_1/GameState.h"
+#include "../Task_1/RoundKernel.h"
+#include "../Task_1/Rules.h"
+#include "HardwareCounters.h"
+
+struct BenchmarkResult {
+    std::string name;
+    std::string unit = "round";
+    long long operations = 0;
+    long long checksum = 0;
+    double seconds = 0.0;
+    CounterValues counters;
+};
+
+// Starts the timer and the counters together, so both cover exactly the measured loop
+class Measurement {
+public:
+    Measurement(HardwareCounters& counters) : counters_(counters) {
+        counters_.start();
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    void finish(BenchmarkResult& result) {
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+        result.counters = counters_.stop();
+    }
+
+private:
+    HardwareCounters& counters_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Feeds everyone, sows whatever land can be sown and never trades land
+template <typename Rules>
+void applyScriptedDecisions(GameState& state) {
+    state.land_bought = 0;
+    state.land_sold = 0;
+    state.wheat_consumed = MathUtils::clamp(state.population * Rules::wheat_per_person, 0, state.wheat_amount);
+    state.wheat_sown = MathUtils::clamp(state.land_amount / Rules::acres_per_sown_wheat, 0, state.wheat_amount - state.wheat_consumed);
+}
+
+template <typename Rules>
+BenchmarkResult runRoundKernel(HardwareCounters& counters, const std::string& name, const int games, const int evaluation_round_index, const unsigned seed) {
+    BenchmarkResult result;
+    result.name = name;
+    SeededRandom random(seed);
+
+    Measurement measurement(counters);
+
+    for (int game = 0; game < games; game++) {
+        GameState state;
+
+        while (state.round_index < evaluation_round_index) {
+            state.land_price = RoundKernel<Rules>::rollLandPrice(random);
+            applyScriptedDecisions<Rules>(state);
+            result.operations++;
+
+            if (RoundKernel<Rules>::applyRound(state, RoundKernel<Rules>::rollRound(random)).game_over) {
+                break;
+            }
+        }
+
+        result.checksum += static_cast<int>(RoundKernel<Rules>::evaluate(state, evaluation_round_index))
+            + state.population + state.wheat_amount;
+    }
+
+    measurement.finish(result);
+    return result;
+}
+
+// The whole console round: prompts, parsing, the std::function validity predicates of getValidInput
+// and processPostUserInputRoundCalculations, driven by a fixed script and fixed seeds
+BenchmarkResult runScriptedGames(HardwareCounters& counters, const int games) {
+    BenchmarkResult result;
+    result.name = "game_scripted_rounds";
+
+    // Valid for every seed, so no game spends rounds on "Invalid input" retries
+    std::string script;
+    for (int round = 0; round < 10; round++) {
+        script += "c 0 0 600 300 ";
+    }
+
+    Measurement measurement(counters);
+
+    for (int game = 0; game < games; game++) {
+        std::istringstream input(script);
+        std::ostringstream transcript;
+
+        GameConfig config("", 10);
+        config.random_seed = static_cast<uint64_t>(game) + 1;
+
+        Game<DefaultRules> scripted_game(config, input, transcript);
+        while (scripted_game.processRoundTick()) {
+            result.operations++;
+        }
+        result.checksum += static_cast<long long>(transcript.tellp());
+    }
+
+    measurement.finish(result);
+    return result;
+}
+
+BenchmarkResult runRollRandomIntInRange(HardwareCounters& counters, const int calls, const unsigned seed) {
+    BenchmarkResult result;
+    result.name = "math_roll_random_int_in_range";
+    result.unit = "call";
+    srand(seed);
+
+    Measurement measurement(counters);
+    for (int i = 0; i < calls; i++) {
+        result.checksum += MathUtils::rollRandomIntInRange(DefaultRules::land_price_min, DefaultRules::land_price_max);
+    }
+    result.operations = calls;
+    measurement.finish(result);
+    return result;
+}
+
+BenchmarkResult runSeededRandom(HardwareCounters& counters, const int calls, const unsigned seed) {
+    BenchmarkResult result;
+    result.name = "seeded_random_roll_int_in_range";
+    result.unit = "call";
+    SeededRandom random(seed);
+
+    Measurement measurement(counters);
+    for (int i = 0; i < calls; i++) {
+        result.checksum += random.rollIntInRange(DefaultRules::land_price_min, DefaultRules::land_price_max);
+    }
+    result.operations = calls;
+    measurement.finish(result);
+    return result;
+}
+
+BenchmarkResult runClamp(HardwareCounters& counters, const int calls, const unsigned seed) {
+    BenchmarkResult result;
+    result.name = "math_clamp";
+    result.unit = "call";
+
+    // Inputs come from the generator, so the loop can't be folded into a constant
+    SeededRandom random(seed);
+    std::vector<int> inputs(4096);
+    for (int& input : inputs) {
+        input = random.rollIntInRange(-1000, 5000);
+    }
+
+    Measurement measurement(counters);
+    for (int i = 0; i < calls; i++) {
+        result.checksum += MathUtils::clamp(inputs[i & 4095], 0, 4000);
+    }
+    result.operations = calls;
+    measurement.finish(result);
+    return result;
+}
+
+// Same predicate as the land purchase check in Game::pollUserInput, called through the
+// std::function<bool(int, GameState)> getValidInput takes and as a plain lambda
+BenchmarkResult runInputPredicate(HardwareCounters& counters, const int calls, const bool type_erased) {
+    const auto buy_predicate = [](const int input, const GameState& state)
+        { return input >= 0 && input * state.land_price <= state.wheat_amount; };
+    const std::function<bool(int, GameState)> erased_predicate = buy_predicate;
+
+    BenchmarkResult result;
+    result.name = type_erased ? "input_predicate_std_function" : "input_predicate_direct";
+    result.unit = "call";
+
+    GameState state;
+    state.land_price = 20;
+
+    Measurement measurement(counters);
+    for (int i = 0; i < calls; i++) {
+        const int input = i % 300;
+        result.checksum += type_erased ? erased_predicate(input, state) : buy_predicate(input, state);
+    }
+    result.operations = calls;
+    measurement.finish(result);
+    return result;
+}
+
+void printResult(const BenchmarkResult& result) {
+    if (result.operations == 0) {
+        std::cout << result.name << ": no " << result.unit << "s run, checksum " << result.checksum << "\n";
+        return;
+    }
+
+    std::cout << result.name << ": "
+        << result.seconds * 1e9 / result.operations << " ns/" << result.unit << ", "
+        << result.operations / result.seconds << " " << result.unit << "s/sec, ";
+
+    if (result.counters.available) {
+        std::cout
+            << "IPC " << result.counters.instructionsPerCycle() << ", "
+            << result.counters.branch_misses / result.operations << " branch-misses/" << result.unit << ", "
+            << result.counters.cache_misses / result.operations << " cache-misses/" << result.unit << ", ";
+    }
+
+    std::cout << "checksum " << result.checksum << "\n";
+}
+
+// JSON has no nan or infinity, a rate over zero operations or zero time is written as null
+std::string jsonNumber(const double value) {
+    if (!std::isfinite(value)) {
+        return "null";
+    }
+    std::ostringstream number;
+    number.precision(10);
+    number << value;
+    return number.str();
+}
+
+bool writeJson(const std::string& path, const std::vector<BenchmarkResult>& results) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Could not write " << path << "." << std::endl;
+        return false;
+    }
+
+    file.precision(10);
+    file << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& result = results[i];
+        file << "    {\n"
+            << "      \"name\": \"" << result.name << "\",\n"
+            << "      \"unit\": \"" << result.unit << "\",\n"
+            << "      \"operations\": " << result.operations << ",\n"
+            << "      \"seconds\": " << result.seconds << ",\n"
+            << "      \"ns_per_operation\": " << jsonNumber(result.seconds * 1e9 / result.operations) << ",\n"
+            << "      \"operations_per_second\": " << jsonNumber(result.operations / result.seconds) << ",\n"
+            << "      \"checksum\": " << result.checksum << ",\n";
+
+        if (result.counters.available) {
+            file << "      \"counters\": {\n"
+                << "        \"cycles\": " << result.counters.cycles << ",\n"
+                << "        \"instructions\": " << result.counters.instructions << ",\n"
+                << "        \"ipc\": " << result.counters.instructionsPerCycle() << ",\n"
+                << "        \"branch_misses\": " << result.counters.branch_misses << ",\n"
+                << "        \"cache_misses\": " << result.counters.cache_misses << "\n"
+                << "      }\n";
+        }
+        else {
+            file << "      \"counters\": null\n";
+        }
+        file << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    // Task_1_Benchmark [games] [rules file] [--json <file>]
+    std::string json_path = "benchmark_results.json";
+    std::vector<std::string> arguments;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        }
+        else {
+            arguments.push_back(argv[i]);
+        }
+    }
+
+    const int games = arguments.size() > 0 ? std::atoi(arguments[0].c_str()) : 1000000;
+    const bool custom_rules = arguments.size() > 1;
+    const unsigned seed = 42;
+
+    if (custom_rules && !RuntimeRules::loadFromFile(arguments[1])) {
+        return 1;
+    }
+
+    HardwareCounters counters;
+    if (!counters.available()) {
+        std::cout << "Hardware counters unavailable, reporting timing only.\n";
+    }
+
+    const int calls = games * 10;
+    std::vector<BenchmarkResult> results;
+
+    // Unless a variant was loaded both paths run the same games, so the checksums have to match
+    results.push_back(runRoundKernel<DefaultRules>(counters, "round_kernel_default_rules", games, 10, seed));
+    results.push_back(runRoundKernel<RuntimeRules>(counters, "round_kernel_runtime_rules", games, 10, seed));
+    results.push_back(runScriptedGames(counters, std::max(1, games / 100)));
+    results.push_back(runRollRandomIntInRange(counters, calls, seed));
+    results.push_back(runSeededRandom(counters, calls, seed));
+    results.push_back(runClamp(counters, calls, seed));
+    results.push_back(runInputPredicate(counters, calls, true));
+    results.push_back(runInputPredicate(counters, calls, false));
+
+    for (const BenchmarkResult& result : results) {
+        printResult(result);
+    }
+
+    if (!writeJson(json_path, results)) {
+        return 1;
+    }
+
+    if (!custom_rules && results[0].checksum != results[1].checksum) {
+        std::cerr << "Rulesets diverged." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
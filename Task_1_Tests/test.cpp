@@ -0,0 +1,630 @@
+#include "pch.h"
+#include "../Task_1/BotPolicy.h"
+#include "../Task_1/Game.h"
+#include "../Task_1/OutcomeDistribution.h"
+#include "../Task_1/OutcomeStatistics.h"
+#include "../Task_1/PolicyOptimizer.h"
+#include "../Task_1/ReplayRunner.h"
+#include "../Task_1/RoundHistory.h"
+#include "../Task_1/Rules.h"
+#include "../Task_1/SessionStore.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  // Random rounds with values of very different widths, negative ones included
+  std::vector<std::vector<GameState>> randomSessions(const int session_count, const uint64_t seed)
+  {
+    SeededRandom random(seed);
+    std::vector<std::vector<GameState>> sessions;
+
+    for (int i = 0; i < session_count; ++i)
+    {
+      std::vector<GameState> rounds(random.rollIntInRange(1, 10));
+      for (GameState& state : rounds)
+      {
+        state.population = random.rollIntInRange(0, 300);
+        state.land_amount = random.rollIntInRange(0, 100000);
+        state.wheat_amount = random.rollIntInRange(0, 2000000);
+        state.people_died = random.rollIntInRange(0, 100);
+        state.people_arrived = random.rollIntInRange(0, 50);
+        state.land_price = random.rollIntInRange(17, 26);
+        state.plague_multiplier = random.rollIntInRange(0, 1);
+        state.wheat_per_acre = random.rollIntInRange(1, 6);
+        state.wheat_lost = random.rollIntInRange(-5, 5000);
+        state.land_bought = random.rollIntInRange(0, 1000);
+        state.land_sold = random.rollIntInRange(0, 1000);
+        state.wheat_consumed = random.rollIntInRange(0, 4000);
+        state.wheat_sown = random.rollIntInRange(0, 4000);
+        state.people_died_totally = random.rollIntInRange(0, 1000);
+      }
+      sessions.push_back(rounds);
+    }
+    return sessions;
+  }
+}
+
+TEST(RoundHistory, MatchesNaiveReference)
+{
+  // Two full blocks and a partial one
+  const std::vector<std::vector<GameState>> sessions = randomSessions(2 * RoundHistoryStore::kBlockSessions + 45, 7);
+  RoundHistoryStore store(10);
+  for (const std::vector<GameState>& rounds : sessions)
+  {
+    store.appendSession(rounds);
+  }
+  store.flush();
+
+  ASSERT_EQ(store.sessionCount(), static_cast<int64_t>(sessions.size()));
+
+  for (int column = 0; column < static_cast<int>(HistoryColumn::Count); ++column)
+  {
+    const HistoryColumn history_column = static_cast<HistoryColumn>(column);
+
+    for (int round = 0; round < 10; ++round)
+    {
+      int64_t sum = 0;
+      int64_t reached = 0;
+      for (const std::vector<GameState>& rounds : sessions)
+      {
+        if (static_cast<int>(rounds.size()) > round)
+        {
+          sum += RoundHistoryStore::columnValue(rounds[round], history_column);
+          reached++;
+        }
+      }
+
+      const double expected = reached == 0 ? 0.0 : static_cast<double>(sum) / reached;
+      ASSERT_DOUBLE_EQ(store.meanAtRound(history_column, round), expected) << "column " << column << ", round " << round;
+    }
+
+    const int64_t value = RoundHistoryStore::columnValue(sessions[3][0], history_column);
+    for (int min_occurrences = 1; min_occurrences <= 2; ++min_occurrences)
+    {
+      int64_t expected = 0;
+      for (const std::vector<GameState>& rounds : sessions)
+      {
+        int occurrences = 0;
+        for (const GameState& state : rounds)
+        {
+          occurrences += RoundHistoryStore::columnValue(state, history_column) == value ? 1 : 0;
+        }
+        expected += occurrences >= min_occurrences ? 1 : 0;
+      }
+
+      ASSERT_EQ(store.countSessionsWithOccurrences(history_column, value, min_occurrences), expected) << "column " << column;
+    }
+  }
+}
+
+TEST(RoundHistory, SessionRecordedWhenPlayerQuits)
+{
+  std::string script;
+  for (int round = 0; round < 10; ++round)
+  {
+    script += "c 0 0 600 300 ";
+  }
+  script += "q";
+
+  std::istringstream input(script);
+  std::ostringstream output;
+  GameConfig config("", 10);
+  config.random_seed = 3;
+
+  RoundHistoryStore store(10);
+  Game<DefaultRules> game(config, input, output);
+  game.attachRoundHistory(&store);
+  while (game.processRoundTick())
+  {
+  }
+  store.flush();
+
+  ASSERT_EQ(store.sessionCount(), 1);
+  ASSERT_DOUBLE_EQ(store.meanAtRound(HistoryColumn::WheatConsumed, 9), 600.0);
+}
+
+TEST(OutcomeStatistics, GameOverRecordedByGame)
+{
+  // Nobody is fed, so the first round ends the game
+  std::istringstream input("c 0 0 0 0 ");
+  std::ostringstream output;
+  GameConfig config("", 10);
+  config.random_seed = 5;
+
+  OutcomeStatistics statistics;
+  Game<DefaultRules> game(config, input, output);
+  game.attachOutcomeStatistics(&statistics);
+  while (game.processRoundTick())
+  {
+  }
+
+  ASSERT_EQ(statistics.gameOverCount(), 1u);
+}
+
+TEST(ReplayRunner, TypoSkipsOnlyTheBadToken)
+{
+  // Every round but the first is preceded by a stray token, a word or a number too large for int,
+  // which is read up to its last digit before the extraction fails
+  std::string script = "c 0 0 600 300 ";
+  for (int round = 1; round < 10; ++round)
+  {
+    script += round % 2 == 0 ? "c x 0 0 600 300 " : "c 99999999999 0 0 600 300 ";
+  }
+
+  std::istringstream input(script);
+  std::ostringstream output;
+  GameConfig config("", 10);
+  config.random_seed = 3;
+
+  RoundHistoryStore store(10);
+  Game<DefaultRules> game(config, input, output);
+  game.attachRoundHistory(&store);
+  while (game.processRoundTick())
+  {
+  }
+  store.flush();
+
+  ASSERT_EQ(store.sessionCount(), 1);
+  ASSERT_DOUBLE_EQ(store.meanAtRound(HistoryColumn::WheatConsumed, 9), 600.0);
+}
+
+TEST(ReplayRunner, RejectsSessionWithoutSeed)
+{
+  uint64_t digest = 0;
+  ASSERT_FALSE(ReplayRunner<DefaultRules>::replaySession("c 0 0 600 300", digest));
+  ASSERT_TRUE(ReplayRunner<DefaultRules>::replaySession("42 c 0 0 600 300", digest));
+}
+
+TEST(SessionStore, PagedSessionsMatchResidentOnes)
+{
+  // 8 sessions over 2 frames page in and out on every round, the transcripts must not notice
+  const int session_count = 8;
+  SessionStore<DefaultRules> paged("session_store_paged.bin", 2);
+  SessionStore<DefaultRules> resident("session_store_resident.bin", session_count);
+
+  std::vector<int> paged_ids;
+  std::vector<int> resident_ids;
+  std::vector<std::ostringstream> paged_output(session_count);
+  std::vector<std::ostringstream> resident_output(session_count);
+  for (int i = 0; i < session_count; ++i)
+  {
+    paged_ids.push_back(paged.openSession(100 + i, paged_output[i]));
+    resident_ids.push_back(resident.openSession(100 + i, resident_output[i]));
+  }
+
+  for (int round = 0; round < 12; ++round)
+  {
+    for (int i = 0; i < session_count; ++i)
+    {
+      ASSERT_EQ(paged.processInput(paged_ids[i], "c 0 0 600 300", paged_output[i]), InputResult::Applied);
+      ASSERT_EQ(resident.processInput(resident_ids[i], "c 0 0 600 300", resident_output[i]), InputResult::Applied);
+    }
+  }
+
+  ASSERT_LE(paged.residentCount(), 2);
+  for (int i = 0; i < session_count; ++i)
+  {
+    ASSERT_EQ(paged_output[i].str(), resident_output[i].str()) << "session " << i;
+  }
+
+  std::remove("session_store_paged.bin");
+  std::remove("session_store_resident.bin");
+}
+
+TEST(SessionStore, ReportsWhatHappenedToTheInput)
+{
+  SessionStore<DefaultRules> store("session_store_results.bin", 1);
+  std::ostringstream output;
+  const int session_id = store.openSession(1, output);
+  const std::string first_round = output.str();
+
+  ASSERT_EQ(store.processInput(session_id, "c 0 0", output), InputResult::Discarded);
+  ASSERT_EQ(store.processInput(session_id, "c -1 0 0", output), InputResult::Discarded);
+  ASSERT_EQ(output.str(), first_round);
+  ASSERT_EQ(store.processInput(session_id, "c 0 0 600 300", output), InputResult::Applied);
+  ASSERT_EQ(output.str().find("Invalid input"), std::string::npos);
+  ASSERT_EQ(store.processInput(session_id, "q", output), InputResult::Closed);
+  ASSERT_FALSE(store.isOpen(session_id));
+  ASSERT_EQ(store.processInput(session_id, "c 0 0 600 300", output), InputResult::Closed);
+
+  std::remove("session_store_results.bin");
+}
+
+namespace
+{
+  // The value of the last "<label>: <value>" line of a transcript
+  int lastEchoedValue(const std::string& transcript, const std::string& label)
+  {
+    const size_t position = transcript.rfind(label + ": ");
+    return position == std::string::npos ? -1 : std::stoi(transcript.substr(position + label.size() + 2));
+  }
+}
+
+TEST(SessionStore, TradesAtThePriceShownBeforeTheAnswers)
+{
+  SessionStore<DefaultRules> store("session_store_price.bin", 1);
+
+  for (uint64_t seed = 1; seed <= 20; ++seed)
+  {
+    std::ostringstream opening;
+    const int session_id = store.openSession(seed, opening);
+    const int shown_price = lastEchoedValue(opening.str(), "Acre price");
+    ASSERT_GE(shown_price, DefaultRules::land_price_min);
+
+    // 20 acres bought, everyone fed, nothing sown, the wheat left only depends on the price and the rats
+    std::ostringstream round;
+    ASSERT_EQ(store.processInput(session_id, "c 20 0 2000 0", round), InputResult::Applied);
+    const int wheat_lost = lastEchoedValue(round.str(), "Wheat lost to rats");
+    ASSERT_EQ(lastEchoedValue(round.str(), "Wheat"), std::max(0, 2800 - 20 * shown_price - wheat_lost - 2000)) << "seed " << seed;
+    ASSERT_EQ(lastEchoedValue(round.str(), "Acres in use"), 1020);
+
+    store.closeSession(session_id);
+  }
+
+  std::remove("session_store_price.bin");
+}
+
+TEST(SessionStore, ThrowsWhenSlabCannotBeOpened)
+{
+  ASSERT_THROW(SessionStore<DefaultRules>("missing_directory/slab.bin", 1), std::runtime_error);
+}
+
+namespace
+{
+  double totalProbability(const OutcomeDistributionResult& result)
+  {
+    double total = result.game_over_probability;
+    for (const double probability : result.grade_probabilities)
+    {
+      total += probability;
+    }
+    return total;
+  }
+
+  // Share of games per outcome, game overs last
+  std::vector<double> monteCarloOutcomes(const BotPolicy& policy, const int evaluation_round_index, const int games)
+  {
+    std::vector<double> outcomes(static_cast<int>(PerformanceGrade::Excellent) + 2, 0.0);
+    for (int game = 0; game < games; ++game)
+    {
+      SeededRandom random(1000 + game);
+      bool game_over;
+      const GameState state = policy.play<DefaultRules>(random, evaluation_round_index, game_over);
+      const int outcome = game_over
+        ? static_cast<int>(outcomes.size()) - 1
+        : static_cast<int>(RoundKernel<DefaultRules>::evaluate(state, evaluation_round_index));
+      outcomes[outcome] += 1.0 / games;
+    }
+    return outcomes;
+  }
+
+  void expectAgreesWithMonteCarlo(const OutcomeDistributionResult& result, const std::vector<double>& outcomes, const int games)
+  {
+    for (size_t outcome = 0; outcome < outcomes.size(); ++outcome)
+    {
+      const double probability = outcome + 1 == outcomes.size()
+        ? result.game_over_probability
+        : result.grade_probabilities[outcome];
+      const double monte_carlo_error = std::sqrt(probability * (1.0 - probability) / games);
+      const double error = std::sqrt(monte_carlo_error * monte_carlo_error
+        + result.standardErrorBound() * result.standardErrorBound());
+      EXPECT_NEAR(probability, outcomes[outcome], 5.0 * error + 1e-9) << "outcome " << outcome;
+    }
+  }
+}
+
+TEST(OutcomeDistribution, ShortHorizonIsExactAndThreadIndependent)
+{
+  DistributionConfig config;
+  config.evaluation_round_index = 2;
+  config.max_frontier_states = 1 << 20;
+
+  config.thread_count = 1;
+  const OutcomeDistributionResult single = OutcomeDistribution<DefaultRules>(config).evaluatePolicy(BotPolicy());
+  config.thread_count = 3;
+  const OutcomeDistributionResult threaded = OutcomeDistribution<DefaultRules>(config).evaluatePolicy(BotPolicy());
+
+  ASSERT_TRUE(single.isExact());
+  ASSERT_TRUE(threaded.isExact());
+  ASSERT_NEAR(totalProbability(single), 1.0, 1e-9);
+  ASSERT_NEAR(single.game_over_probability, threaded.game_over_probability, 1e-12);
+  for (int grade = 0; grade <= static_cast<int>(PerformanceGrade::Excellent); ++grade)
+  {
+    ASSERT_NEAR(single.grade_probabilities[grade], threaded.grade_probabilities[grade], 1e-12);
+  }
+
+  const int games = 20000;
+  expectAgreesWithMonteCarlo(single, monteCarloOutcomes(BotPolicy(), config.evaluation_round_index, games), games);
+
+  // A resampled run sweeps the states in the same order whatever the thread count
+  config.evaluation_round_index = 4;
+  config.max_frontier_states = 256;
+  config.thread_count = 1;
+  const OutcomeDistributionResult resampled_single = OutcomeDistribution<DefaultRules>(config).evaluatePolicy(BotPolicy());
+  config.thread_count = 3;
+  const OutcomeDistributionResult resampled_threaded = OutcomeDistribution<DefaultRules>(config).evaluatePolicy(BotPolicy());
+
+  ASSERT_FALSE(resampled_single.isExact());
+  ASSERT_EQ(resampled_single.resampled_rounds, resampled_threaded.resampled_rounds);
+  ASSERT_NEAR(resampled_single.game_over_probability, resampled_threaded.game_over_probability, 1e-12);
+  for (int grade = 0; grade <= static_cast<int>(PerformanceGrade::Excellent); ++grade)
+  {
+    ASSERT_NEAR(resampled_single.grade_probabilities[grade], resampled_threaded.grade_probabilities[grade], 1e-12);
+  }
+}
+
+TEST(OutcomeDistribution, ResampledEstimateStaysWithinItsErrorBound)
+{
+  DistributionConfig config;
+  config.evaluation_round_index = 4;
+  config.thread_count = 1;
+  config.max_frontier_states = 256;
+
+  const OutcomeDistributionResult result = OutcomeDistribution<DefaultRules>(config).evaluatePolicy(BotPolicy());
+
+  ASSERT_FALSE(result.isExact());
+  ASSERT_NEAR(totalProbability(result), 1.0, 1e-9);
+
+  const int games = 20000;
+  expectAgreesWithMonteCarlo(result, monteCarloOutcomes(BotPolicy(), config.evaluation_round_index, games), games);
+}
+
+namespace
+{
+  // Relative to this file, so it works from any working directory the runner picks
+  std::string repositoryPath(const std::string& relative_path)
+  {
+    const std::string source = __FILE__;
+    const size_t separator = source.find_last_of("/\\");
+    return (separator == std::string::npos ? std::string(".") : source.substr(0, separator)) + "/../" + relative_path;
+  }
+
+  bool loadRules(const std::string& contents)
+  {
+    {
+      std::ofstream rules_file("runtime_rules_test.txt");
+      rules_file << contents;
+    }
+    const bool loaded = RuntimeRules::loadFromFile("runtime_rules_test.txt");
+    std::remove("runtime_rules_test.txt");
+    return loaded;
+  }
+
+  bool runtimeRulesMatchDefaults()
+  {
+    return RuntimeRules::land_price_min == DefaultRules::land_price_min
+      && RuntimeRules::land_price_max == DefaultRules::land_price_max
+      && RuntimeRules::wheat_per_acre_min == DefaultRules::wheat_per_acre_min
+      && RuntimeRules::wheat_per_acre_max == DefaultRules::wheat_per_acre_max
+      && RuntimeRules::rats_loss_percent_min == DefaultRules::rats_loss_percent_min
+      && RuntimeRules::rats_loss_percent_max == DefaultRules::rats_loss_percent_max
+      && RuntimeRules::rats_loss_divisor == DefaultRules::rats_loss_divisor
+      && RuntimeRules::wheat_per_person == DefaultRules::wheat_per_person
+      && RuntimeRules::acres_per_worker == DefaultRules::acres_per_worker
+      && RuntimeRules::acres_per_sown_wheat == DefaultRules::acres_per_sown_wheat
+      && RuntimeRules::arrival_deaths_divisor == DefaultRules::arrival_deaths_divisor
+      && RuntimeRules::arrival_yield_baseline == DefaultRules::arrival_yield_baseline
+      && RuntimeRules::arrival_wheat_divisor == DefaultRules::arrival_wheat_divisor
+      && RuntimeRules::base_arrivals_per_round == DefaultRules::base_arrivals_per_round
+      && RuntimeRules::max_arrivals_per_round == DefaultRules::max_arrivals_per_round
+      && RuntimeRules::plague_roll_max == DefaultRules::plague_roll_max
+      && RuntimeRules::plague_chance_percent == DefaultRules::plague_chance_percent
+      && RuntimeRules::game_over_mortality_percent == DefaultRules::game_over_mortality_percent
+      && RuntimeRules::bad_death_rate == DefaultRules::bad_death_rate
+      && RuntimeRules::bad_acres_per_person == DefaultRules::bad_acres_per_person
+      && RuntimeRules::satisfactory_death_rate == DefaultRules::satisfactory_death_rate
+      && RuntimeRules::satisfactory_acres_per_person == DefaultRules::satisfactory_acres_per_person
+      && RuntimeRules::good_death_rate == DefaultRules::good_death_rate
+      && RuntimeRules::good_acres_per_person == DefaultRules::good_acres_per_person;
+  }
+}
+
+TEST(RuntimeRules, ShippedFileReproducesDefaultRules)
+{
+  ASSERT_TRUE(loadRules("land_price_min 5\nplague_chance_percent 40\narrival_wheat_divisor 300\n"));
+  ASSERT_EQ(RuntimeRules::land_price_min, 5);
+  ASSERT_FALSE(runtimeRulesMatchDefaults());
+
+  ASSERT_TRUE(RuntimeRules::loadFromFile(repositoryPath("Task_1/rules.txt")));
+  ASSERT_TRUE(runtimeRulesMatchDefaults());
+}
+
+TEST(RuntimeRules, RejectsInvalidFiles)
+{
+  ASSERT_FALSE(RuntimeRules::loadFromFile("missing_rules_file.txt"));
+  ASSERT_FALSE(loadRules("no_such_rule 3\n"));
+  ASSERT_FALSE(loadRules("land_price_min seventeen\n"));
+
+  ASSERT_TRUE(RuntimeRules::loadFromFile(repositoryPath("Task_1/rules.txt")));
+  ASSERT_FALSE(loadRules("acres_per_sown_wheat 0\n"));
+  ASSERT_TRUE(RuntimeRules::loadFromFile(repositoryPath("Task_1/rules.txt")));
+  ASSERT_FALSE(loadRules("land_price_min 0\n"));
+  ASSERT_TRUE(RuntimeRules::loadFromFile(repositoryPath("Task_1/rules.txt")));
+  ASSERT_FALSE(loadRules("plague_chance_percent 101\n"));
+  ASSERT_TRUE(RuntimeRules::loadFromFile(repositoryPath("Task_1/rules.txt")));
+  ASSERT_FALSE(loadRules("plague_roll_max 2147483647\n"));
+  ASSERT_TRUE(RuntimeRules::loadFromFile(repositoryPath("Task_1/rules.txt")));
+  ASSERT_FALSE(loadRules("wheat_per_acre_max 2147483647\n"));
+
+  ASSERT_TRUE(RuntimeRules::loadFromFile(repositoryPath("Task_1/rules.txt")));
+  ASSERT_FALSE(loadRules("land_price_min 30\nland_price_max 20\n"));
+  ASSERT_TRUE(RuntimeRules::loadFromFile(repositoryPath("Task_1/rules.txt")));
+  ASSERT_FALSE(loadRules("plague_roll_max 10\n"));
+
+  ASSERT_TRUE(RuntimeRules::loadFromFile(repositoryPath("Task_1/rules.txt")));
+  ASSERT_TRUE(runtimeRulesMatchDefaults());
+}
+
+namespace
+{
+  OptimizerConfig smallOptimizerConfig(const std::string& checkpoint_path)
+  {
+    OptimizerConfig config;
+    config.population_size = 6;
+    config.games_per_candidate = 20;
+    config.thread_count = 1;
+    config.checkpoint_path = checkpoint_path;
+    return config;
+  }
+
+  std::string readFile(const std::string& path)
+  {
+    std::ifstream file(path);
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+  }
+
+  void expectSamePolicy(const BotPolicy& a, const BotPolicy& b)
+  {
+    EXPECT_EQ(a.buy_below_price, b.buy_below_price);
+    EXPECT_EQ(a.sell_above_price, b.sell_above_price);
+    EXPECT_EQ(a.trade_fraction, b.trade_fraction);
+    EXPECT_EQ(a.consumption_ratio, b.consumption_ratio);
+    EXPECT_EQ(a.sowing_ratio, b.sowing_ratio);
+  }
+}
+
+TEST(PolicyOptimizer, CheckpointRoundTrip)
+{
+  std::remove("optimizer_round_trip.txt");
+  PolicyOptimizer<DefaultRules> optimizer(smallOptimizerConfig("optimizer_round_trip.txt"));
+  ASSERT_FALSE(optimizer.resumedFromCheckpoint());
+  optimizer.run(2);
+
+  const PolicyOptimizer<DefaultRules> resumed(smallOptimizerConfig("optimizer_round_trip.txt"));
+  ASSERT_TRUE(resumed.resumedFromCheckpoint());
+  ASSERT_EQ(resumed.bestFitness(), optimizer.bestFitness());
+  expectSamePolicy(resumed.bestPolicy(), optimizer.bestPolicy());
+
+  // Read quietly, a report on the policy shouldn't claim to resume an optimization
+  BotPolicy loaded;
+  testing::internal::CaptureStdout();
+  testing::internal::CaptureStderr();
+  ASSERT_TRUE(PolicyOptimizer<DefaultRules>::loadBestPolicy(smallOptimizerConfig("optimizer_round_trip.txt"), loaded));
+  ASSERT_FALSE(PolicyOptimizer<DefaultRules>::loadBestPolicy(smallOptimizerConfig("optimizer_missing.txt"), loaded));
+  ASSERT_EQ(testing::internal::GetCapturedStdout(), "");
+  ASSERT_EQ(testing::internal::GetCapturedStderr(), "");
+  expectSamePolicy(loaded, optimizer.bestPolicy());
+
+  std::remove("optimizer_round_trip.txt");
+}
+
+TEST(PolicyOptimizer, IgnoresCheckpointFromOtherSettings)
+{
+  std::remove("optimizer_other_settings.txt");
+  PolicyOptimizer<DefaultRules>(smallOptimizerConfig("optimizer_other_settings.txt")).run(1);
+
+  OptimizerConfig other_seed = smallOptimizerConfig("optimizer_other_settings.txt");
+  other_seed.seed = 2;
+  ASSERT_FALSE(PolicyOptimizer<DefaultRules>(other_seed).resumedFromCheckpoint());
+
+  OptimizerConfig other_games = smallOptimizerConfig("optimizer_other_settings.txt");
+  other_games.games_per_candidate = 21;
+  ASSERT_FALSE(PolicyOptimizer<DefaultRules>(other_games).resumedFromCheckpoint());
+
+  ASSERT_TRUE(PolicyOptimizer<DefaultRules>(smallOptimizerConfig("optimizer_other_settings.txt")).resumedFromCheckpoint());
+
+  std::remove("optimizer_other_settings.txt");
+}
+
+TEST(PolicyOptimizer, ResumedRunMatchesUninterruptedOne)
+{
+  std::remove("optimizer_uninterrupted.txt");
+  std::remove("optimizer_interrupted.txt");
+
+  PolicyOptimizer<DefaultRules> uninterrupted(smallOptimizerConfig("optimizer_uninterrupted.txt"));
+  uninterrupted.run(3);
+
+  PolicyOptimizer<DefaultRules>(smallOptimizerConfig("optimizer_interrupted.txt")).run(1);
+  PolicyOptimizer<DefaultRules> resumed(smallOptimizerConfig("optimizer_interrupted.txt"));
+  ASSERT_TRUE(resumed.resumedFromCheckpoint());
+  resumed.run(2);
+
+  ASSERT_EQ(resumed.bestFitness(), uninterrupted.bestFitness());
+  expectSamePolicy(resumed.bestPolicy(), uninterrupted.bestPolicy());
+  ASSERT_EQ(readFile("optimizer_interrupted.txt"), readFile("optimizer_uninterrupted.txt"));
+
+  std::remove("optimizer_uninterrupted.txt");
+  std::remove("optimizer_interrupted.txt");
+}
+
+TEST(OutcomeStatistics, HistogramQuantilesWithinOneSixtyFourth)
+{
+  // Log-uniform over eight decades, so every part of the bucket layout is hit
+  SeededRandom random(11);
+  std::vector<int64_t> values;
+  LogLinearHistogram histogram;
+  for (int i = 0; i < 100000; ++i)
+  {
+    const double exponent = 8.0 * random.rollIntInRange(0, 1000000) / 1000000.0;
+    const int64_t value = static_cast<int64_t>(std::pow(10.0, exponent));
+    values.push_back(value);
+    histogram.record(value);
+  }
+  std::sort(values.begin(), values.end());
+
+  const double quantiles[] = { 0.0, 0.001, 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999, 1.0 };
+  for (const double quantile : quantiles)
+  {
+    // Same rank rule as valueAtQuantile: the nearest rank, at least the first value
+    const size_t rank = std::max<size_t>(1, static_cast<size_t>(quantile * values.size() + 0.5));
+    const int64_t exact = values[rank - 1];
+    const int64_t estimate = histogram.valueAtQuantile(quantile);
+    ASSERT_LE(std::abs(static_cast<double>(estimate - exact)), exact / 64.0) << "quantile " << quantile;
+  }
+}
+
+TEST(OutcomeStatistics, MergedShardsMatchSingleInstance)
+{
+  const int shard_count = 4;
+  OutcomeStatisticsShards shards(shard_count);
+  OutcomeStatistics single;
+
+  SeededRandom random(13);
+  for (int game = 0; game < 5000; ++game)
+  {
+    OutcomeStatistics& shard = shards.shard(game % shard_count);
+    if (random.rollIntInRange(0, 9) == 0)
+    {
+      shard.recordGameOver();
+      single.recordGameOver();
+      continue;
+    }
+
+    GameState state;
+    state.population = random.rollIntInRange(0, 500);
+    state.people_died_totally = random.rollIntInRange(0, 2000);
+    state.wheat_amount = random.rollIntInRange(0, 5000000);
+    state.land_amount = random.rollIntInRange(0, 100000);
+    const PerformanceGrade grade = static_cast<PerformanceGrade>(random.rollIntInRange(0, 3));
+    shard.recordEvaluatedGame(state, grade);
+    single.recordEvaluatedGame(state, grade);
+  }
+
+  OutcomeStatistics merged;
+  shards.snapshot(merged);
+
+  ASSERT_EQ(merged.gameOverCount(), single.gameOverCount());
+  for (int grade = 0; grade <= static_cast<int>(PerformanceGrade::Excellent); ++grade)
+  {
+    ASSERT_EQ(merged.gradeCount(static_cast<PerformanceGrade>(grade)), single.gradeCount(static_cast<PerformanceGrade>(grade)));
+  }
+  for (int metric = 0; metric < static_cast<int>(OutcomeMetric::Count); ++metric)
+  {
+    const LogLinearHistogram& merged_histogram = merged.histogram(static_cast<OutcomeMetric>(metric));
+    const LogLinearHistogram& single_histogram = single.histogram(static_cast<OutcomeMetric>(metric));
+    ASSERT_EQ(merged_histogram.totalCount(), single_histogram.totalCount());
+    for (int permille = 0; permille <= 1000; ++permille)
+    {
+      ASSERT_EQ(merged_histogram.valueAtQuantile(permille / 1000.0), single_histogram.valueAtQuantile(permille / 1000.0))
+        << "metric " << metric << ", quantile " << permille / 1000.0;
+    }
+  }
+}
@@ -1,8 +1,450 @@
 ﻿#pragma once
 
 #include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+template <typename T>
+class DynamicArray;
+
+// Bit-packed specialization, 64 flags per word.
+// Bits past size_ are kept at zero, so the bulk operations can work on whole words.
+template <>
+class DynamicArray<bool> final
+{
+private:
+	int capacity_;
+	int size_;
+	uint64_t* words_;
+	constexpr static int initial_capacity_ = 64;
+	constexpr static int bits_per_word_ = 64;
+
+	static int WordCount(int bits)
+	{
+		return (bits + bits_per_word_ - 1) / bits_per_word_;
+	}
+
+	static int PopCount(uint64_t word)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_popcountll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		return static_cast<int>(__popcnt64(word));
+#elif defined(_MSC_VER) && defined(_M_IX86)
+		// Win32 has no 64-bit popcnt, count the halves
+		return static_cast<int>(__popcnt(static_cast<unsigned int>(word)) + __popcnt(static_cast<unsigned int>(word >> 32)));
+#else
+		word = word - ((word >> 1) & 0x5555555555555555ULL);
+		word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+		word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		return static_cast<int>((word * 0x0101010101010101ULL) >> 56);
+#endif
+	}
+
+	static int TrailingZeros(uint64_t word)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_ctzll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanForward64(&index, word);
+		return static_cast<int>(index);
+#elif defined(_MSC_VER) && defined(_M_IX86)
+		// Win32 has no 64-bit bit scan, try the low half first
+		unsigned long index;
+		if (_BitScanForward(&index, static_cast<unsigned long>(word)))
+		{
+			return static_cast<int>(index);
+		}
+		_BitScanForward(&index, static_cast<unsigned long>(word >> 32));
+		return static_cast<int>(index) + 32;
+#else
+		int zeros = 0;
+		while ((word & 1) == 0)
+		{
+			word >>= 1;
+			zeros++;
+		}
+		return zeros;
+#endif
+	}
+
+	// Mask of the bits in use in the last word
+	uint64_t TailMask() const
+	{
+		const int used_bits = size_ % bits_per_word_;
+		return used_bits == 0 ? ~0ULL : (1ULL << used_bits) - 1;
+	}
+
+	void IncreaseSize()
+	{
+		const int old_word_count = WordCount(capacity_);
+		capacity_ *= 2;
+		const int new_word_count = WordCount(capacity_);
+
+		uint64_t* tmp = static_cast<uint64_t*>(malloc(sizeof(uint64_t) * new_word_count));
+		memcpy(tmp, words_, sizeof(uint64_t) * old_word_count);
+		memset(tmp + old_word_count, 0, sizeof(uint64_t) * (new_word_count - old_word_count));
+
+		free(words_);
+		words_ = tmp;
+	}
+
+	void CheckSameSize(const DynamicArray& arr) const
+	{
+		if (arr.size_ != size_)
+		{
+			throw std::invalid_argument("Bit arrays must have the same size");
+		}
+	}
+
+public:
+	class BitReference
+	{
+	private:
+		uint64_t* word_;
+		uint64_t mask_;
+	public:
+		BitReference(uint64_t* word, int bit) : word_(word), mask_(1ULL << bit) {}
+
+		operator bool() const
+		{
+			return (*word_ & mask_) != 0;
+		}
+
+		BitReference& operator=(bool value)
+		{
+			if (value)
+				*word_ |= mask_;
+			else
+				*word_ &= ~mask_;
+			return *this;
+		}
+
+		BitReference& operator=(const BitReference& other)
+		{
+			return *this = static_cast<bool>(other);
+		}
+
+		void flip()
+		{
+			*word_ ^= mask_;
+		}
+	};
+
+	DynamicArray() :DynamicArray(initial_capacity_) {}
+
+	DynamicArray(int capacity)
+	{
+		assert(capacity > 0 && "Capacity must be a natural number");
+		capacity_ = WordCount(capacity) * bits_per_word_;
+		words_ = static_cast<uint64_t*>(calloc(WordCount(capacity_), sizeof(uint64_t)));
+		size_ = 0;
+	}
+
+	~DynamicArray()
+	{
+		free(words_);
+	}
+
+	// Copy constructor
+	DynamicArray(const DynamicArray& arr) : DynamicArray(arr.capacity_)
+	{
+		memcpy(words_, arr.words_, sizeof(uint64_t) * WordCount(arr.capacity_));
+		size_ = arr.size_;
+	}
+
+	// Move constructor
+	DynamicArray(DynamicArray&& arr) noexcept
+	{
+		words_ = arr.words_;
+		size_ = arr.size_;
+		capacity_ = arr.capacity_;
+
+		arr.words_ = nullptr;
+		arr.size_ = 0;
+		arr.capacity_ = 0;
+	}
+
+	int Insert(bool value)
+	{
+		if (size_ == capacity_)
+		{
+			IncreaseSize();
+		}
+		size_++;
+		(*this)[size_ - 1] = value;
+		return size_ - 1;
+	}
+
+	int Insert(int index, bool value)
+	{
+		if (index > size_ || index < 0)
+		{
+			throw std::out_of_range("Target index was out of array bounds");
+		}
+
+		if (size_ == capacity_)
+		{
+			IncreaseSize();
+		}
+
+		// Shift whole words up by one bit, carrying the top bit of each word into the next
+		const int first_word = index / bits_per_word_;
+		for (int i = WordCount(size_ + 1) - 1; i > first_word; --i)
+		{
+			words_[i] = (words_[i] << 1) | (words_[i - 1] >> (bits_per_word_ - 1));
+		}
+
+		const uint64_t low_mask = (1ULL << (index % bits_per_word_)) - 1;
+		const uint64_t word = words_[first_word];
+		words_[first_word] = (word & low_mask) | ((word & ~low_mask) << 1);
+
+		size_++;
+		(*this)[index] = value;
+		return index;
+	}
+
+	// Remove from indexed position
+	void Remove(int index)
+	{
+		if (index >= size_ || index < 0)
+		{
+			throw std::out_of_range("Target index was out of array bounds");
+		}
+
+		const int first_word = index / bits_per_word_;
+		const int word_count = WordCount(size_);
+
+		const uint64_t low_mask = (1ULL << (index % bits_per_word_)) - 1;
+		const uint64_t word = words_[first_word];
+		words_[first_word] = (word & low_mask) | ((word >> 1) & ~low_mask);
+
+		for (int i = first_word + 1; i < word_count; ++i)
+		{
+			words_[i - 1] |= words_[i] << (bits_per_word_ - 1);
+			words_[i] >>= 1;
+		}
+
+		size_--;
+	}
+
+	BitReference operator[](int index)
+	{
+		return BitReference(words_ + index / bits_per_word_, index % bits_per_word_);
+	}
+
+	bool operator[](int index) const
+	{
+		return (words_[index / bits_per_word_] >> (index % bits_per_word_) & 1) != 0;
+	}
+
+	int size() const
+	{
+		return size_;
+	}
+
+	// Number of set flags
+	int Count() const
+	{
+		const int word_count = WordCount(size_);
+		int count = 0;
+		for (int i = 0; i < word_count; ++i)
+		{
+			count += PopCount(words_[i]);
+		}
+		return count;
+	}
+
+	// Index of the first flag equal to value, -1 if there is none
+	int FindFirst(bool value) const
+	{
+		const int word_count = WordCount(size_);
+		for (int i = 0; i < word_count; ++i)
+		{
+			uint64_t word = value ? words_[i] : ~words_[i];
+			if (i == word_count - 1)
+			{
+				word &= TailMask();
+			}
+
+			if (word != 0)
+			{
+				return i * bits_per_word_ + TrailingZeros(word);
+			}
+		}
+		return -1;
+	}
+
+	// The bulk operations below are plain word loops, which the optimizer vectorizes
+	void And(const DynamicArray& arr)
+	{
+		CheckSameSize(arr);
+		const int word_count = WordCount(size_);
+		for (int i = 0; i < word_count; ++i)
+		{
+			words_[i] &= arr.words_[i];
+		}
+	}
+
+	void Or(const DynamicArray& arr)
+	{
+		CheckSameSize(arr);
+		const int word_count = WordCount(size_);
+		for (int i = 0; i < word_count; ++i)
+		{
+			words_[i] |= arr.words_[i];
+		}
+	}
+
+	void Xor(const DynamicArray& arr)
+	{
+		CheckSameSize(arr);
+		const int word_count = WordCount(size_);
+		for (int i = 0; i < word_count; ++i)
+		{
+			words_[i] ^= arr.words_[i];
+		}
+	}
+
+	void Not()
+	{
+		const int word_count = WordCount(size_);
+		for (int i = 0; i < word_count; ++i)
+		{
+			words_[i] = ~words_[i];
+		}
+
+		if (word_count > 0)
+		{
+			words_[word_count - 1] &= TailMask();
+		}
+	}
+
+	class Iterator
+	{
+	private:
+		DynamicArray<bool>* owner_;
+		int current_index_;
+		bool reverse_traversal_;
+		bool has_next_;
+	public:
+		Iterator(DynamicArray<bool>* owner, const bool reverse_traversal)
+		{
+			owner_ = owner;
+			reverse_traversal_ = reverse_traversal;
+			has_next_ = owner_->size_ > 0;
+			current_index_ = reverse_traversal_ ? owner->size_ - 1 : 0;
+		}
+
+		bool get() const
+		{
+			return static_cast<const DynamicArray<bool>&>(*owner_)[current_index_];
+		}
+
+		void set(bool value)
+		{
+			(*owner_)[current_index_] = value;
+		}
+
+		void next()
+		{
+			if (!has_next_)
+				return;
+
+			if (reverse_traversal_)
+			{
+				current_index_--;
+				if (current_index_ == -1)
+					has_next_ = false;
+			}
+			else
+			{
+				current_index_++;
+				if (current_index_ == owner_->size_)
+					has_next_ = false;
+			}
+		}
+
+		bool hasNext() const
+		{
+			return has_next_;
+		}
+	};
+
+	class ConstIterator
+	{
+	private:
+		const DynamicArray<bool>* owner_;
+		int current_index_;
+		bool reverse_traversal_;
+		bool has_next_;
+	public:
+		ConstIterator(const DynamicArray<bool>* owner, const bool reverse_traversal)
+		{
+			owner_ = owner;
+			reverse_traversal_ = reverse_traversal;
+			has_next_ = owner_->size_ > 0;
+			current_index_ = reverse_traversal_ ? owner->size_ - 1 : 0;
+		}
+
+		bool get() const
+		{
+			return (*owner_)[current_index_];
+		}
+
+		void next()
+		{
+			if (!has_next_)
+				return;
+
+			if (reverse_traversal_)
+			{
+				current_index_--;
+				if (current_index_ == -1)
+					has_next_ = false;
+			}
+			else
+			{
+				current_index_++;
+				if (current_index_ == owner_->size_)
+					has_next_ = false;
+			}
+		}
+
+		bool hasNext() const
+		{
+			return has_next_;
+		}
+	};
+
+	Iterator iterator()
+	{
+		return Iterator(this, false);
+	}
+
+	ConstIterator iterator() const
+	{
+		return ConstIterator(this, false);
+	}
+
+	Iterator reversedIterator()
+	{
+		return Iterator(this, true);
+	}
+
+	ConstIterator reversedIterator() const
+	{
+		return ConstIterator(this, true);
+	}
+};
+
 template <typename T>
 class DynamicArray final
 {
@@ -12,6 +454,14 @@ private:
 	T* data_;
 	constexpr static int initial_capacity_ = 8;
 	constexpr static float growth_factor_ = 2.0f;
+
+	// Lazy removal: Remove only marks a slot here and Compact drops the marked slots in one pass.
+	// Only allocated while lazy removal is on, most arrays never use it.
+	DynamicArray<bool>* removed_ = nullptr;
+	int removed_count_ = 0;
+	bool lazy_removal_ = false;
+	float max_removed_ratio_ = default_max_removed_ratio_;
+	constexpr static float default_max_removed_ratio_ = 0.5f;
 	
 	void IncreaseSize()
 	{
@@ -37,6 +487,22 @@ private:
 		ReleaseArray();
 		data_ = tmp;
 	}
+
+	void MarkRemoved(int index)
+	{
+		if (index >= size_ || index < 0)
+		{
+			throw std::out_of_range("Target index was out of array bounds");
+		}
+
+		if ((*removed_)[index])
+		{
+			throw std::invalid_argument("Element at target index was already removed");
+		}
+
+		(*removed_)[index] = true;
+		removed_count_++;
+	}
 	
 public:
 	DynamicArray() :DynamicArray(initial_capacity_) {}
@@ -51,6 +517,7 @@ public:
 	~DynamicArray()
 	{
 		ReleaseArray();
+		delete removed_;
 	}
 	
 	void ReleaseArray()
@@ -71,6 +538,13 @@ public:
 			new (data_ + i) T(arr[i]);
 			size_++;
 		}
+		if (arr.removed_ != nullptr)
+		{
+			removed_ = new DynamicArray<bool>(*arr.removed_);
+		}
+		removed_count_ = arr.removed_count_;
+		lazy_removal_ = arr.lazy_removal_;
+		max_removed_ratio_ = arr.max_removed_ratio_;
 	}
 
 	// Move constructor
@@ -79,20 +553,39 @@ public:
 		data_ = arr.data_;
 		size_ = arr.size_;
 		capacity_ = arr.capacity_;
+		removed_count_ = arr.removed_count_;
+		lazy_removal_ = arr.lazy_removal_;
+		max_removed_ratio_ = arr.max_removed_ratio_;
+		removed_ = arr.removed_;
 
 		arr.data_ = nullptr;
 		arr.size_ = 0;
 		arr.capacity_ = 0;
+		arr.removed_count_ = 0;
+		arr.lazy_removal_ = false;
+		arr.removed_ = nullptr;
 	}
 	
+	// With lazy removal on, the array is compacted first once too many slots are removed,
+	// so indices returned before may move
 	int Insert(const T& value)
 	{
+		if (lazy_removal_ && removed_count_ > size_ * max_removed_ratio_)
+		{
+			Compact();
+		}
+
 		if (size_ == capacity_)
 		{
 			IncreaseSize();
 		}
 		new (data_ + size_) T(value);
 		size_++;
+
+		if (lazy_removal_)
+		{
+			removed_->Insert(false);
+		}
 		return size_ - 1;
 	}
 	
@@ -126,12 +619,24 @@ public:
 		}*/
 		new(data_ + index) T(value);
 		size_++;
+
+		if (lazy_removal_)
+		{
+			removed_->Insert(index, false);
+		}
 		return index;
 	}
 
-	// Remove from indexed position
+	// Remove from indexed position. With lazy removal on, the slot is only marked as removed
+	// and the indices of the other elements stay valid until the next compaction.
 	void Remove(int index)
 	{
+		if (lazy_removal_)
+		{
+			MarkRemoved(index);
+			return;
+		}
+
 		if (index > size_ || index < 0)
 		{
 			throw std::out_of_range("Target index was out of array bounds");
@@ -158,6 +663,71 @@ public:
 		size_--;
 	}
 
+	// Switches Remove between shifting the tail right away and marking tombstones.
+	// Turning lazy removal off compacts the array.
+	void SetLazyRemoval(bool enabled, float max_removed_ratio = default_max_removed_ratio_)
+	{
+		max_removed_ratio_ = max_removed_ratio;
+		if (enabled == lazy_removal_)
+		{
+			return;
+		}
+
+		if (enabled)
+		{
+			removed_ = new DynamicArray<bool>(size_ > 0 ? size_ : 1);
+			for (int i = 0; i < size_; ++i)
+			{
+				removed_->Insert(false);
+			}
+		}
+		else
+		{
+			Compact();
+			delete removed_;
+			removed_ = nullptr;
+		}
+		lazy_removal_ = enabled;
+	}
+
+	bool IsRemoved(int index) const
+	{
+		return lazy_removal_ && (*removed_)[index];
+	}
+
+	// Drops every removed slot in a single linear pass
+	void Compact()
+	{
+		if (removed_count_ == 0)
+		{
+			return;
+		}
+
+		int live = 0;
+		for (int i = 0; i < size_; ++i)
+		{
+			if ((*removed_)[i])
+			{
+				data_[i].~T();
+				continue;
+			}
+
+			if (live != i)
+			{
+				new (data_ + live) T(std::move(data_[i]));
+				data_[i].~T();
+				(*removed_)[live] = false;
+			}
+			live++;
+		}
+
+		while (removed_->size() > live)
+		{
+			removed_->Remove(removed_->size() - 1);
+		}
+		size_ = live;
+		removed_count_ = 0;
+	}
 
 	T& operator[](int index)
 	{
@@ -169,10 +739,57 @@ public:
 		return data_[index];
 	}
 
+	// Number of slots, removed ones included until they are compacted away
 	int size() const
 	{
 		return size_;
 	}
+
+	int liveSize() const
+	{
+		return size_ - removed_count_;
+	}
+
+	// Random access to the elements that are not removed. It holds pointers into the array,
+	// so it is invalidated by any insertion or compaction.
+	class LiveView
+	{
+	private:
+		const DynamicArray<T>* owner_;
+		DynamicArray<T*> elements_;
+	public:
+		LiveView(DynamicArray<T>* owner) : owner_(owner), elements_(owner->liveSize() > 0 ? owner->liveSize() : 1)
+		{
+			for (int i = 0; i < owner_->size_; ++i)
+			{
+				if (!owner_->IsRemoved(i))
+				{
+					elements_.Insert(owner->data_ + i);
+				}
+			}
+		}
+
+		T& operator[](int index)
+		{
+			return *elements_[index];
+		}
+
+		// Index of the view's element in the owning array, e.g. to Remove it
+		int slotIndex(int index) const
+		{
+			return static_cast<int>(elements_[index] - owner_->data_);
+		}
+
+		int size() const
+		{
+			return elements_.size();
+		}
+	};
+
+	LiveView liveView()
+	{
+		return LiveView(this);
+	}
 	
 	class Iterator
 	{
@@ -195,6 +812,11 @@ public:
 			{
 				current_index_ = 0;
 			}
+
+			if (has_next_ && owner_->IsRemoved(current_index_))
+			{
+				next();
+			}
 		}
 		const T& get() const
 		{
@@ -206,23 +828,27 @@ public:
 			owner_->data_[current_index_] = value;
 		}
 
+		// Skips removed slots
 		void next()
 		{
 			if (!has_next_)
 				return;
 
-			if (reverse_traversal_)
+			do
 			{
-				current_index_--;
-				if (current_index_ == -1)
-					has_next_ = false;
-			}
-			else
-			{
-				current_index_++;
-				if (current_index_ == owner_->size_)
-					has_next_ = false;
-			}
+				if (reverse_traversal_)
+				{
+					current_index_--;
+					if (current_index_ == -1)
+						has_next_ = false;
+				}
+				else
+				{
+					current_index_++;
+					if (current_index_ == owner_->size_)
+						has_next_ = false;
+				}
+			} while (has_next_ && owner_->IsRemoved(current_index_));
 		}
 
 		bool hasNext() const
@@ -234,12 +860,12 @@ public:
 	class ConstIterator
 	{
 	private:
-		DynamicArray<T>* owner_;
+		const DynamicArray<T>* owner_;
 		int current_index_;
 		bool reverse_traversal_;
 		bool has_next_;
 	public:
-		ConstIterator(DynamicArray<T>* owner, const bool reverse_traversal)
+		ConstIterator(const DynamicArray<T>* owner, const bool reverse_traversal)
 		{
 			owner_ = owner;
 			reverse_traversal_ = reverse_traversal;
@@ -252,29 +878,38 @@ public:
 			{
 				current_index_ = 0;
 			}
+
+			if (has_next_ && owner_->IsRemoved(current_index_))
+			{
+				next();
+			}
 		}
 		const T& get() const
 		{
 			return owner_->data_[current_index_];
 		}
 
+		// Skips removed slots
 		void next()
 		{
 			if (!has_next_)
 				return;
 
-			if (reverse_traversal_)
+			do
 			{
-				current_index_--;
-				if (current_index_ == 0)
-					has_next_ = false;
-			}
-			else
-			{
-				current_index_++;
-				if (current_index_ == owner_->size_)
-					has_next_ = false;
-			}
+				if (reverse_traversal_)
+				{
+					current_index_--;
+					if (current_index_ == -1)
+						has_next_ = false;
+				}
+				else
+				{
+					current_index_++;
+					if (current_index_ == owner_->size_)
+						has_next_ = false;
+				}
+			} while (has_next_ && owner_->IsRemoved(current_index_));
 		}
 
 		bool hasNext() const
@@ -0,0 +1,374 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "DynamicArray.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+constexpr static int cache_line_size = 64;
+
+// Ring buffer capacities are powers of two, so a position maps to its slot with a mask
+inline int RoundUpToPowerOfTwo(int capacity)
+{
+	assert(capacity > 0 && "Capacity must be a natural number");
+	if (capacity > (1 << 30))
+	{
+		throw std::invalid_argument("Capacity is above the largest power of two an int can hold");
+	}
+
+	int rounded = 1;
+	while (rounded < capacity)
+	{
+		rounded *= 2;
+	}
+	return rounded;
+}
+
+// Busy waits, lowest latency while a core can be spared for each waiting thread
+class SpinWait
+{
+public:
+	template <typename Predicate>
+	void WaitUntil(Predicate ready)
+	{
+		while (!ready())
+		{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+			_mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+			__builtin_ia32_pause();
+#endif
+		}
+	}
+
+	void Notify() {}
+};
+
+// Spins briefly, then hands the core back to the scheduler between checks
+class YieldWait
+{
+public:
+	template <typename Predicate>
+	void WaitUntil(Predicate ready)
+	{
+		for (int attempt = 0; !ready(); ++attempt)
+		{
+			if (attempt >= spin_attempts_)
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void Notify() {}
+
+private:
+	constexpr static int spin_attempts_ = 64;
+};
+
+// Sleeps on a condition variable. The mutex is only taken by threads that actually sleep
+// and by Notify while somebody sleeps, so the fast path stays lock-free.
+class BlockingWait
+{
+public:
+	template <typename Predicate>
+	void WaitUntil(Predicate ready)
+	{
+		if (ready())
+		{
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		waiters_.fetch_add(1);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		condition_.wait(lock, ready);
+		waiters_.fetch_sub(1);
+	}
+
+	void Notify()
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (waiters_.load(std::memory_order_relaxed) > 0)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			condition_.notify_all();
+		}
+	}
+
+private:
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	std::atomic<int> waiters_{ 0 };
+};
+
+// Bounded single producer, single consumer queue. TryPush and TryPop are wait-free.
+template <typename T, typename WaitStrategy = SpinWait>
+class SpscRingBuffer final
+{
+private:
+	DynamicArray<T> slots_;
+	uint64_t mask_;
+
+	alignas(cache_line_size) std::atomic<uint64_t> head_{ 0 };
+	uint64_t cached_tail_ = 0;
+
+	alignas(cache_line_size) std::atomic<uint64_t> tail_{ 0 };
+	uint64_t cached_head_ = 0;
+
+	alignas(cache_line_size) WaitStrategy not_empty_;
+	WaitStrategy not_full_;
+
+public:
+	// Capacity is rounded up to a power of two
+	SpscRingBuffer(int capacity) : slots_(RoundUpToPowerOfTwo(capacity))
+	{
+		const int rounded_capacity = RoundUpToPowerOfTwo(capacity);
+		for (int i = 0; i < rounded_capacity; ++i)
+		{
+			slots_.Insert(T());
+		}
+		mask_ = static_cast<uint64_t>(rounded_capacity - 1);
+	}
+
+	SpscRingBuffer(const SpscRingBuffer&) = delete;
+	SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+	int capacity() const
+	{
+		return slots_.size();
+	}
+
+	bool TryPush(const T& value)
+	{
+		return TryPushBatch(&value, 1) == 1;
+	}
+
+	// Pushes as many items as fit, publishing them with a single store
+	int TryPushBatch(const T* values, int count)
+	{
+		if (count <= 0)
+		{
+			return 0;
+		}
+
+		const uint64_t tail = tail_.load(std::memory_order_relaxed);
+		uint64_t free_slots = capacity() - (tail - cached_head_);
+		if (free_slots < static_cast<uint64_t>(count))
+		{
+			cached_head_ = head_.load(std::memory_order_acquire);
+			free_slots = capacity() - (tail - cached_head_);
+		}
+
+		const int pushed = free_slots < static_cast<uint64_t>(count) ? static_cast<int>(free_slots) : count;
+		for (int i = 0; i < pushed; ++i)
+		{
+			slots_[static_cast<int>((tail + i) & mask_)] = values[i];
+		}
+
+		if (pushed > 0)
+		{
+			tail_.store(tail + pushed, std::memory_order_release);
+			not_empty_.Notify();
+		}
+		return pushed;
+	}
+
+	bool TryPop(T& value)
+	{
+		return TryPopBatch(&value, 1) == 1;
+	}
+
+	// Pops up to max_count items, releasing their slots with a single store
+	int TryPopBatch(T* values, int max_count)
+	{
+		if (max_count <= 0)
+		{
+			return 0;
+		}
+
+		const uint64_t head = head_.load(std::memory_order_relaxed);
+		uint64_t ready = cached_tail_ - head;
+		if (ready < static_cast<uint64_t>(max_count))
+		{
+			cached_tail_ = tail_.load(std::memory_order_acquire);
+			ready = cached_tail_ - head;
+		}
+
+		const int popped = ready < static_cast<uint64_t>(max_count) ? static_cast<int>(ready) : max_count;
+		for (int i = 0; i < popped; ++i)
+		{
+			values[i] = std::move(slots_[static_cast<int>((head + i) & mask_)]);
+		}
+
+		if (popped > 0)
+		{
+			head_.store(head + popped, std::memory_order_release);
+			not_full_.Notify();
+		}
+		return popped;
+	}
+
+	void Push(const T& value)
+	{
+		not_full_.WaitUntil([this]() { return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_acquire) < mask_ + 1; });
+		TryPush(value);
+	}
+
+	T Pop()
+	{
+		T value{};
+		not_empty_.WaitUntil([this]() { return tail_.load(std::memory_order_acquire) != head_.load(std::memory_order_relaxed); });
+		TryPop(value);
+		return value;
+	}
+};
+
+// Bounded multiple producer, single consumer queue. Producers claim slots with a CAS on the tail
+// and publish each slot through its own sequence number, so they never wait for each other's copies.
+template <typename T, typename WaitStrategy = SpinWait>
+class MpscRingBuffer final
+{
+private:
+	struct Slot
+	{
+		std::atomic<uint64_t> sequence{ 0 };
+		T value;
+
+		Slot() = default;
+
+		// Needed by DynamicArray storage, only used while the buffer is being set up
+		Slot(const Slot& slot) : sequence(slot.sequence.load(std::memory_order_relaxed)), value(slot.value) {}
+	};
+
+	DynamicArray<Slot> slots_;
+	uint64_t mask_;
+
+	alignas(cache_line_size) std::atomic<uint64_t> head_{ 0 };
+
+	alignas(cache_line_size) std::atomic<uint64_t> tail_{ 0 };
+
+	alignas(cache_line_size) WaitStrategy not_empty_;
+	WaitStrategy not_full_;
+
+public:
+	// Capacity is rounded up to a power of two
+	MpscRingBuffer(int capacity) : slots_(RoundUpToPowerOfTwo(capacity))
+	{
+		const int rounded_capacity = RoundUpToPowerOfTwo(capacity);
+		for (int i = 0; i < rounded_capacity; ++i)
+		{
+			slots_.Insert(Slot());
+		}
+		mask_ = static_cast<uint64_t>(rounded_capacity - 1);
+	}
+
+	MpscRingBuffer(const MpscRingBuffer&) = delete;
+	MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+
+	int capacity() const
+	{
+		return slots_.size();
+	}
+
+	bool TryPush(const T& value)
+	{
+		return TryPushBatch(&value, 1) == 1;
+	}
+
+	// Claims room for as many items as fit with one CAS
+	int TryPushBatch(const T* values, int count)
+	{
+		if (count <= 0)
+		{
+			return 0;
+		}
+
+		uint64_t tail = tail_.load(std::memory_order_relaxed);
+		int claimed;
+
+		do
+		{
+			const uint64_t free_slots = capacity() - (tail - head_.load(std::memory_order_acquire));
+			claimed = free_slots < static_cast<uint64_t>(count) ? static_cast<int>(free_slots) : count;
+			if (claimed == 0)
+			{
+				return 0;
+			}
+		} while (!tail_.compare_exchange_weak(tail, tail + claimed, std::memory_order_relaxed));
+
+		for (int i = 0; i < claimed; ++i)
+		{
+			Slot& slot = slots_[static_cast<int>((tail + i) & mask_)];
+			slot.value = values[i];
+			slot.sequence.store(tail + i + 1, std::memory_order_release);
+		}
+
+		not_empty_.Notify();
+		return claimed;
+	}
+
+	bool TryPop(T& value)
+	{
+		return TryPopBatch(&value, 1) == 1;
+	}
+
+	// Pops up to max_count published items in order, releasing their slots with a single store
+	int TryPopBatch(T* values, int max_count)
+	{
+		if (max_count <= 0)
+		{
+			return 0;
+		}
+
+		const uint64_t head = head_.load(std::memory_order_relaxed);
+
+		int popped = 0;
+		while (popped < max_count)
+		{
+			Slot& slot = slots_[static_cast<int>((head + popped) & mask_)];
+			if (slot.sequence.load(std::memory_order_acquire) != head + popped + 1)
+			{
+				break;
+			}
+			values[popped] = std::move(slot.value);
+			popped++;
+		}
+
+		if (popped > 0)
+		{
+			head_.store(head + popped, std::memory_order_release);
+			not_full_.Notify();
+		}
+		return popped;
+	}
+
+	void Push(const T& value)
+	{
+		while (!TryPush(value))
+		{
+			not_full_.WaitUntil([this]() { return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_acquire) < mask_ + 1; });
+		}
+	}
+
+	T Pop()
+	{
+		T value{};
+		not_empty_.WaitUntil([this]() {
+			const uint64_t head = head_.load(std::memory_order_relaxed);
+			return slots_[static_cast<int>(head & mask_)].sequence.load(std::memory_order_acquire) == head + 1;
+		});
+		TryPop(value);
+		return value;
+	}
+};
@@ -1,5 +1,8 @@
 #include "pch.h"
 #include "../Task_2/DynamicArray.h"
+#include "../Task_2/RingBuffer.h"
+#include <thread>
+#include <vector>
 
 TEST(Insert, InsertInt)
 {
@@ -247,4 +250,404 @@ TEST(Iterator, TestForwardIteratorSetString)
   {
     ASSERT_EQ("42", it.get());
   }
-}
\ No newline at end of file
+}
+
+TEST(Insert, InsertBool)
+{
+  DynamicArray<bool> arr;
+  
+  for (int i = 0; i < 200; ++i)
+  {
+    arr.Insert(i % 3 == 0);
+  }
+
+  for (int i = 0; i < 200; ++i)
+  {
+    ASSERT_EQ(arr[i], i % 3 == 0);
+  }
+}
+
+TEST(Insert, InsertBoolByIndex)
+{
+  DynamicArray<bool> arr;
+  std::vector<bool> target_arr;
+
+  for (int i = 0; i < 150; ++i)
+  {
+    const int index = (i * 7) % (arr.size() + 1);
+    arr.Insert(index, i % 2 == 0);
+    target_arr.insert(target_arr.begin() + index, i % 2 == 0);
+  }
+
+  ASSERT_EQ(arr.size(), 150);
+  for (int i = 0; i < 150; ++i)
+  {
+    ASSERT_EQ(arr[i], target_arr[i]);
+  }
+}
+
+TEST(Remove, RemoveBool)
+{
+  DynamicArray<bool> arr;
+  std::vector<bool> target_arr;
+
+  for (int i = 0; i < 200; ++i)
+  {
+    arr.Insert(i % 5 < 2);
+    target_arr.push_back(i % 5 < 2);
+  }
+
+  for (int i = 0; i < 100; ++i)
+  {
+    const int index = (i * 13) % arr.size();
+    arr.Remove(index);
+    target_arr.erase(target_arr.begin() + index);
+  }
+
+  ASSERT_EQ(arr.size(), 100);
+  for (int i = 0; i < 100; ++i)
+  {
+    ASSERT_EQ(arr[i], target_arr[i]);
+  }
+}
+
+TEST(BitOperations, CountAndFindFirst)
+{
+  DynamicArray<bool> arr;
+  
+  for (int i = 0; i < 130; ++i)
+  {
+    arr.Insert(false);
+  }
+
+  ASSERT_EQ(arr.Count(), 0);
+  ASSERT_EQ(arr.FindFirst(true), -1);
+  ASSERT_EQ(arr.FindFirst(false), 0);
+
+  arr[100] = true;
+  arr[129] = true;
+  
+  ASSERT_EQ(arr.Count(), 2);
+  ASSERT_EQ(arr.FindFirst(true), 100);
+
+  arr.Not();
+
+  ASSERT_EQ(arr.Count(), 128);
+  ASSERT_EQ(arr.FindFirst(false), 100);
+}
+
+TEST(BitOperations, AndOrXor)
+{
+  DynamicArray<bool> lhs;
+  DynamicArray<bool> rhs;
+  
+  for (int i = 0; i < 100; ++i)
+  {
+    lhs.Insert(i % 2 == 0);
+    rhs.Insert(i % 3 == 0);
+  }
+
+  DynamicArray<bool> and_arr(lhs);
+  and_arr.And(rhs);
+  DynamicArray<bool> or_arr(lhs);
+  or_arr.Or(rhs);
+  DynamicArray<bool> xor_arr(lhs);
+  xor_arr.Xor(rhs);
+
+  for (int i = 0; i < 100; ++i)
+  {
+    ASSERT_EQ(and_arr[i], i % 2 == 0 && i % 3 == 0);
+    ASSERT_EQ(or_arr[i], i % 2 == 0 || i % 3 == 0);
+    ASSERT_EQ(xor_arr[i], (i % 2 == 0) != (i % 3 == 0));
+  }
+}
+
+TEST(Iterator, TestForwardIteratorSetBool)
+{
+  DynamicArray<bool> arr;
+  
+  for (int i = 0; i < 70; ++i)
+  {
+    arr.Insert(false);
+  }
+
+  for (auto it = arr.iterator(); it.hasNext(); it.next())
+  {
+    it.set(true);
+  }
+  
+  ASSERT_EQ(arr.Count(), 70);
+}
+
+
+TEST(Remove, LazyRemoveString)
+{
+  DynamicArray<std::string> arr;
+  std::vector<std::string> target_arr;
+  arr.SetLazyRemoval(true);
+
+  for (int i = 0; i < 100; ++i)
+  {
+    arr.Insert(std::to_string(i));
+  }
+
+  for (int i = 0; i < 100; ++i)
+  {
+    if (i % 3 == 0)
+    {
+      arr.Remove(i);
+    }
+    else
+    {
+      target_arr.push_back(std::to_string(i));
+    }
+  }
+
+  ASSERT_EQ(arr.size(), 100);
+  ASSERT_EQ(arr.liveSize(), 66);
+  ASSERT_TRUE(arr.IsRemoved(99));
+  ASSERT_EQ(arr[98], "98");
+  ASSERT_THROW(arr.Remove(99), std::invalid_argument);
+
+  arr.Compact();
+  ASSERT_EQ(arr.size(), 66);
+  for (int i = 0; i < 66; ++i)
+  {
+    ASSERT_FALSE(arr.IsRemoved(i));
+    ASSERT_EQ(arr[i], target_arr[i]);
+  }
+}
+
+TEST(Iterator, TestIteratorsSkipRemoved)
+{
+  DynamicArray<int> arr;
+  arr.SetLazyRemoval(true);
+
+  for (int i = 0; i < 10; ++i)
+  {
+    arr.Insert(i);
+  }
+  arr.Remove(0);
+  arr.Remove(4);
+  arr.Remove(5);
+  arr.Remove(9);
+
+  const int target_arr[] = { 1, 2, 3, 6, 7, 8 };
+  int i = 0;
+  for (auto it = arr.iterator(); it.hasNext(); it.next())
+  {
+    ASSERT_EQ(it.get(), target_arr[i++]);
+  }
+  ASSERT_EQ(i, 6);
+
+  for (auto it = arr.reversedIterator(); it.hasNext(); it.next())
+  {
+    ASSERT_EQ(it.get(), target_arr[--i]);
+  }
+  ASSERT_EQ(i, 0);
+}
+
+TEST(Remove, LazyRemoveCompaction)
+{
+  DynamicArray<int> arr;
+  arr.SetLazyRemoval(true, 0.25f);
+
+  for (int i = 0; i < 40; ++i)
+  {
+    arr.Insert(i);
+  }
+
+  auto view = arr.liveView();
+  for (int i = 0; i < view.size(); i += 2)
+  {
+    arr.Remove(view.slotIndex(i));
+  }
+
+  auto live = arr.liveView();
+  ASSERT_EQ(live.size(), 20);
+  for (int i = 0; i < live.size(); ++i)
+  {
+    ASSERT_EQ(live[i], 2 * i + 1);
+  }
+
+  // Half of the slots are removed, past the ratio, so appending compacts first
+  ASSERT_EQ(arr.Insert(40), 20);
+  ASSERT_EQ(arr.size(), 21);
+  ASSERT_EQ(arr[0], 1);
+
+  arr.Remove(0);
+  arr.SetLazyRemoval(false);
+  ASSERT_EQ(arr.size(), 20);
+  ASSERT_EQ(arr[0], 3);
+
+  arr.Remove(0);
+  ASSERT_EQ(arr.size(), 19);
+  ASSERT_EQ(arr[0], 5);
+}
+
+TEST(Remove, LazyRemoveCopyAndMove)
+{
+  DynamicArray<std::string> arr;
+  arr.Insert("a");
+  arr.Insert("b");
+  arr.Insert("c");
+  arr.SetLazyRemoval(true);
+  arr.Remove(1);
+
+  DynamicArray<std::string> copy(arr);
+  ASSERT_TRUE(copy.IsRemoved(1));
+  ASSERT_EQ(copy.liveSize(), 2);
+
+  DynamicArray<std::string> moved(std::move(arr));
+  ASSERT_TRUE(moved.IsRemoved(1));
+  moved.Remove(0);
+  ASSERT_EQ(moved.liveSize(), 1);
+
+  // The copy keeps its own tombstones
+  ASSERT_FALSE(copy.IsRemoved(0));
+  copy.SetLazyRemoval(false);
+  ASSERT_EQ(copy.size(), 2);
+  ASSERT_EQ(copy[1], "c");
+
+  copy.SetLazyRemoval(true);
+  copy.Remove(0);
+  ASSERT_EQ(copy.liveSize(), 1);
+}
+
+TEST(RingBuffer, SpscPushPopOrder)
+{
+  SpscRingBuffer<int> buffer(6);
+  
+  ASSERT_EQ(buffer.capacity(), 8);
+
+  for (int i = 0; i < 8; ++i)
+  {
+    ASSERT_TRUE(buffer.TryPush(i));
+  }
+  ASSERT_FALSE(buffer.TryPush(8));
+
+  int value;
+  for (int i = 0; i < 8; ++i)
+  {
+    ASSERT_TRUE(buffer.TryPop(value));
+    ASSERT_EQ(value, i);
+  }
+  ASSERT_FALSE(buffer.TryPop(value));
+}
+
+TEST(RingBuffer, SpscBatchWrapsAround)
+{
+  SpscRingBuffer<std::string> buffer(4);
+  const std::string source_arr[] = { "foo", "bar", "buz" };
+  std::string target_arr[4];
+
+  for (int round = 0; round < 5; ++round)
+  {
+    ASSERT_EQ(buffer.TryPushBatch(source_arr, 3), 3);
+    ASSERT_EQ(buffer.TryPushBatch(source_arr, 3), 1);
+    ASSERT_EQ(buffer.TryPopBatch(target_arr, 4), 4);
+
+    ASSERT_EQ(target_arr[0], "foo");
+    ASSERT_EQ(target_arr[2], "buz");
+    ASSERT_EQ(target_arr[3], "foo");
+  }
+}
+
+TEST(RingBuffer, RejectsBadCountsAndCapacities)
+{
+  SpscRingBuffer<int> spsc(4);
+  MpscRingBuffer<int> mpsc(4);
+  int values[2] = { 1, 2 };
+
+  ASSERT_EQ(spsc.TryPushBatch(values, -1), 0);
+  ASSERT_EQ(spsc.TryPopBatch(values, -1), 0);
+  ASSERT_EQ(mpsc.TryPushBatch(values, -1), 0);
+  ASSERT_EQ(mpsc.TryPopBatch(values, -1), 0);
+  ASSERT_EQ(spsc.TryPushBatch(values, 0), 0);
+  ASSERT_EQ(mpsc.TryPushBatch(values, 0), 0);
+
+  ASSERT_EQ(RoundUpToPowerOfTwo(1 << 30), 1 << 30);
+  ASSERT_THROW(RoundUpToPowerOfTwo((1 << 30) + 1), std::invalid_argument);
+}
+
+TEST(RingBuffer, SpscThreadedBlocking)
+{
+  SpscRingBuffer<int, BlockingWait> buffer(16);
+  const int item_count = 100000;
+
+  std::thread producer([&buffer]()
+  {
+    for (int i = 0; i < item_count; ++i)
+    {
+      buffer.Push(i);
+    }
+  });
+
+  for (int i = 0; i < item_count; ++i)
+  {
+    ASSERT_EQ(buffer.Pop(), i);
+  }
+  producer.join();
+}
+
+TEST(RingBuffer, MpscThreadedProducers)
+{
+  MpscRingBuffer<int, YieldWait> buffer(64);
+  const int producer_count = 4;
+  const int items_per_producer = 20000;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < producer_count; ++p)
+  {
+    producers.emplace_back([&buffer, p]()
+    {
+      int batch[4];
+      for (int i = 0; i < items_per_producer; i += 4)
+      {
+        for (int j = 0; j < 4; ++j)
+        {
+          batch[j] = p * items_per_producer + i + j;
+        }
+
+        int pushed = 0;
+        while (pushed < 4)
+        {
+          const int batch_pushed = buffer.TryPushBatch(batch + pushed, 4 - pushed);
+          if (batch_pushed == 0)
+          {
+            std::this_thread::yield();
+          }
+          pushed += batch_pushed;
+        }
+      }
+    });
+  }
+
+  // Items of one producer must arrive in the order they were pushed
+  std::vector<int> last_seen(producer_count, -1);
+  int values[16];
+  for (int received = 0; received < producer_count * items_per_producer;)
+  {
+    const int popped = buffer.TryPopBatch(values, 16);
+    if (popped == 0)
+    {
+      std::this_thread::yield();
+    }
+    for (int i = 0; i < popped; ++i)
+    {
+      const int producer = values[i] / items_per_producer;
+      ASSERT_LT(last_seen[producer], values[i]);
+      last_seen[producer] = values[i];
+    }
+    received += popped;
+  }
+
+  for (auto& producer : producers)
+  {
+    producer.join();
+  }
+  for (int p = 0; p < producer_count; ++p)
+  {
+    ASSERT_EQ(last_seen[p], (p + 1) * items_per_producer - 1);
+  }
+}